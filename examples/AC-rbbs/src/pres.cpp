@@ -10,10 +10,7 @@ namespace crypto12381::ac_rbbs
         
         auto r = random-select_in<Zp>;
 
-        auto A_ = A^r;
-        auto B_ = B^r;
-        auto C_J_ = C_J^r;
-        auto D_ = D^r;
+        auto [A_, B_, C_J_, D_] = pow_all(r, A, B, C_J, D);
 
         auto [α, β] = random-select_in<Zp^2>;
         auto U = (C_I^α) * (A_^β);
@@ -12,8 +12,7 @@ namespace crypto12381::ac_rbbs
         const size_t n = a.size();
         auto [A, w] = parse<G1, Zp>(sig);
         auto I = indexs | algebraic;
-        auto J = sequence(n)
-            | filter([&](size_t i){ return not std::ranges::contains(I, i); });
+        const auto J = ~index_set{ n, indexs };
         
         auto C_I = g * Π[i.in(I)](Y[i]^a[i]);
         auto B = C_I * (A^-w);
@@ -23,7 +22,7 @@ namespace crypto12381::ac_rbbs
         auto Yks = sequence(2*n)
             | std::views::transform([&](size_t k){
                 auto valid_i = I
-                | filter([&](size_t i){ return std::ranges::contains(J, k - n + i); });
+                | filter([&](size_t i){ return J.contains(k - n + i); });
                 if(not valid_i.empty())
                 {
                     return std::make_optional(Y[k]^Σ[i.in(valid_i)](q[i] * a[k - n + i])); 
@@ -38,7 +37,7 @@ namespace crypto12381::ac_rbbs
             })
         ;
 
-        auto D = Π(Yks);
+        auto D = Π(parallel, Yks | materialize);
 
         return serialize(C_I, C_J, B, D);
     }
@@ -12,7 +12,7 @@ namespace crypto12381::ac_rps
         const size_t n = a.size();
         auto [h, sigma, tilde_M] = parse<G1^2|G2>(sig);
         auto I = indexes | algebraic;
-        auto J = sequence(n) | filter([&](size_t i){ return not std::ranges::contains(I, i); });
+        const auto J = ~index_set{ n, indexes };
         auto tilde_H = parse<G2>(redact_cache);
         auto [g, tilde_g, tilde_X] = parse<G1|G2^2>(pk.fixed_part);
         auto Y = parse<G1>(pk.Y) | materialize;
@@ -36,7 +36,7 @@ namespace crypto12381::ac_rps
             | std::views::transform([&](size_t k){
                 auto valid_ii = sequence(I_plus.size())
                     | filter([&](size_t ii){
-                        return std::ranges::contains(J, k + I_plus[ii] - n - 1uz);
+                        return J.contains(k + I_plus[ii] - n - 1uz);
                     });
                 if(not valid_ii.empty())
                 {
@@ -17,7 +17,6 @@ namespace crypto12381::mhac_bbs
         auto [g1, g2] = parse<G1, G2>(pp.g1_g2);
         auto h = parse<G1>(pp.h);
         auto w = parse<G2>(pk);
-        const auto& Rev = type.Rev;
         auto C_rev = parse<G1>(type.C_rev);
         auto Prv = private_indexes | algebraic;
         auto pub_a = parse<Zp>(public_attributes);
@@ -26,14 +25,13 @@ namespace crypto12381::mhac_bbs
         auto z_hid_pub = parse<Zp>(pres.z_hid_pub);
 
         const size_t m = h.size();
-        auto Hid = sequence(m)
-            | filter([&](size_t i){ return not std::ranges::contains(Rev, i); });
-        auto Hid_Pub = Hid
-            | filter([&](size_t i){ return not std::ranges::contains(Prv, i); });
+        const index_set Rev{ m, type.Rev };
+        const index_set Prv_set{ m, private_indexes };
+        auto Hid_Pub = ~(Rev | Prv_set) | materialize;
 
-        auto Pub = sequence(m) | filter([&](size_t i){ return not std::ranges::contains(Prv, i); });
+        auto Pub = ~Prv_set | materialize;
         auto I_Pub_in_Rev = sequence(Pub.size())
-            | filter([&](size_t i){ return std::ranges::contains(Rev, Pub[i]); });
+            | filter([&](size_t i){ return Rev.contains(Pub[i]); });
 
         //G1_element auto C_rev = g1 * Π[ii.in(I_Pub_in_Rev)](h[Pub[ii]]^pub_a[ii]);
         G1_element auto C_hid = 
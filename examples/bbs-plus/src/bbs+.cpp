@@ -69,6 +69,6 @@ namespace crypto12381::bbs_plus
 
         auto [A, x, r] = parse<G1, Zp, Zp>(signature);
 
-        return pair(A, w * (g2^x)) == pair(g1 * (h0^r) * Π[n](h[i]^m[i]), g2);
+        return pair(A, w * (g2^vartime(x))) == pair(g1 * (h0^vartime(r)) * Π[n](h[i]^vartime(m[i])), g2);
     }
 } 
\ No newline at end of file
@@ -70,6 +70,6 @@ namespace crypto12381::bbs
 
         auto [A, x] = parse<G1, Zp>(signature);
 
-        return pair(A, w * (g2^x)) == pair(g1 * Π[n](h[i]^m[i]), g2);
+        return pair(A, w * (g2^vartime(x))) == pair(g1 * Π[n](h[i]^vartime(m[i])), g2);
     }
 } 
\ No newline at end of file
@@ -29,7 +29,7 @@ namespace crypto12381::ps
         auto m = hash(message).to(Zp);
         auto [σ1, σ2] = parse<G1^2>(signature);
         
-        return pair(σ1, X2 * (Y2^m)) == pair(σ2, g2);
+        return pair(σ1, X2 * (Y2^vartime(m))) == pair(σ2, g2);
     }
 
     Signature randomnize(const Signature& signature, RandomEngine& random)
@@ -95,7 +95,7 @@ namespace crypto12381::ps
 
         auto [σ1, σ2] = parse<G1, G1>(signature);
 
-        return pair(σ1, X2 * Π[n](Y2[i] ^ m[i])) == pair(σ2, g2);
+        return pair(σ1, X2 * Π[n](Y2[i] ^ vartime(m[i]))) == pair(σ2, g2);
     }
 
     As As::setup(RandomEngine& random)
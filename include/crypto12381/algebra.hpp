@@ -4,6 +4,10 @@
 #include <array>
 #include <ranges>
 #include <functional>
+#include <stdexcept>
+
+#include "arena.hpp"
+#include "index_set.hpp"
 
 namespace crypto12381 
 {
@@ -134,8 +138,9 @@ namespace crypto12381
                 }
                 else
                 {
-                    return algebraic_range<decltype(std::forward<unwrap_t>(unwrap_r) | std::ranges::to<std::vector>())>{
-                        std::forward<unwrap_t>(unwrap_r) | std::ranges::to<std::vector>()
+                    using value_t = std::ranges::range_value_t<unwrap_t>;
+                    return algebraic_range<scratch_vector<value_t>>{
+                        std::forward<unwrap_t>(unwrap_r) | std::ranges::to<scratch_vector<value_t>>(result_resource())
                     };
                 }
             }
@@ -151,13 +156,60 @@ namespace crypto12381
         };
 
         inline constexpr unwrap_all_fn unwrap_all{};
+
+        // exactly N elements kept in place in an array, without any allocation
+        template<size_t N>
+        struct materialize_array_fn : std::ranges::range_adaptor_closure<materialize_array_fn<N>>
+        {
+            template<std::ranges::range R> requires std::ranges::forward_range<R> || std::ranges::sized_range<R>
+            constexpr auto operator()(R&& r)const
+            {
+                auto&& base = unwrap(std::forward<R>(r));
+                using value_t = std::ranges::range_value_t<decltype(base)>;
+                if(static_cast<size_t>(std::ranges::distance(base)) != N)
+                {
+                    throw std::runtime_error{ "The range does not have the materialized size." };
+                }
+
+                auto iter = std::ranges::begin(base);
+                auto next = [&]() -> value_t
+                {
+                    value_t element = *iter;
+                    ++iter;
+                    return element;
+                };
+                return [&]<size_t...I>(std::index_sequence<I...>){
+                    return algebraic_range<std::array<value_t, N>>{ std::array<value_t, N>{ ((void)I, next())... } };
+                }(std::make_index_sequence<N>{});
+            }
+        };
+
+        // the elements are kept in the arena of the current thread if it holds the results, see arena_scope
+        struct materialize_fn : std::ranges::range_adaptor_closure<materialize_fn>
+        {
+            template<std::ranges::range R>
+            constexpr auto operator()(R&& r)const
+            {
+                using value_t = std::ranges::range_value_t<decltype(unwrap(std::forward<R>(r)))>;
+                return algebraic_range<scratch_vector<value_t>>{
+                    std::ranges::to<scratch_vector<value_t>>(unwrap(std::forward<R>(r)), result_resource())
+                };
+            }
+
+            // r | materialize(constant<N>) for a size known at compile time
+            template<typename T, T N>
+            constexpr auto operator()(std::integral_constant<T, N>)const noexcept
+            {
+                return materialize_array_fn<static_cast<size_t>(N)>{};
+            }
+        };
     }
     
     inline namespace functors 
     {
         inline constexpr detail::algebraic_fn algebraic{};
 
-        inline constexpr auto materialize = detail::unwrap_all | std::ranges::to<std::vector>() | algebraic;
+        inline constexpr detail::materialize_fn materialize{};
     }
 
     namespace detail 
@@ -189,6 +241,20 @@ namespace crypto12381
 
     namespace detail 
     {
+        // an index_set excludes its members with a single test each
+        template<class E, class Arg>
+        constexpr bool kept_by_except(const E& e, const Arg& arg)
+        {
+            if constexpr(std::same_as<Arg, index_set>)
+            {
+                return not arg.contains(e);
+            }
+            else
+            {
+                return e != arg;
+            }
+        }
+
         struct except_fn : symbolic_functor_interface<except_fn>
         {
             using symbolic_functor_interface<except_fn>::operator();
@@ -198,7 +264,7 @@ namespace crypto12381
         {
             return filter([args = std::tuple<Args...>((Args&&)args...)](auto&& e){
                 return [&]<size_t...I>(std::index_sequence<I...>){
-                    return (true && ... && (e != std::get<I>(args)));
+                    return (true && ... && kept_by_except(e, std::get<I>(args)));
                 }(std::index_sequence_for<Args...>{});
             });
         };
@@ -282,6 +348,37 @@ namespace crypto12381
     {
         inline constexpr detail::pass_fn pass;
     }    
+
+    namespace detail::hoist_ns
+    {
+        void hoist();
+
+        // a lazy value, e.g. g ^ x or the Miller loop of pair(A, w), which hoist(value) evaluates
+        template<class T>
+        concept lazy_value = not symbolic<T> && requires(T&& t){ hoist((T&&)t); };
+
+        // a lazy value, or an expression whose arguments have one
+        template<class T>
+        concept has_lazy_values = lazy_value<T> || requires{ requires std::remove_cvref_t<T>::has_lazy_values; };
+
+        // an argument of type Arg with nothing to evaluate keeps its category
+        template<class Arg, class T>
+        constexpr decltype(auto) hoist_argument(T&& t)
+        {
+            if constexpr(lazy_value<T>)
+            {
+                return hoist((T&&)t);
+            }
+            else if constexpr(has_lazy_values<T>)
+            {
+                return ((T&&)t).hoist();
+            }
+            else
+            {
+                return (Arg)(T&&)t;
+            }
+        }
+    }
 }
 
 
@@ -314,10 +411,22 @@ namespace crypto12381
                     )>; 
                 })
                 {
-                    return (TValue&&)substitution.value 
-                    | transform([expr = std::tuple<T>{ (T&&)t }]<class E, class Self>(this Self&& self, E&& e){
-                        return std::get<0>(std::forward_like<Self>(expr)) || symbol_substitution<Name, E>{ (E&&)e };
-                    });
+                    auto substitute_each = [&]<class TExpr>(TExpr&& expr)
+                    {
+                        return (TValue&&)substitution.value 
+                        | transform([expr = std::tuple<TExpr>{ (TExpr&&)expr }]<class E, class Self>(this Self&& self, E&& e){
+                            return std::get<0>(std::forward_like<Self>(expr)) || symbol_substitution<Name, E>{ (E&&)e };
+                        });
+                    };
+                    // the lazy values do not depend on Name, so they are evaluated once for all the elements
+                    if constexpr(hoist_ns::has_lazy_values<T>)
+                    {
+                        return substitute_each(((T&&)t).hoist());
+                    }
+                    else
+                    {
+                        return substitute_each((T&&)t);
+                    }
                 }
                 else 
                 {
@@ -516,6 +625,20 @@ namespace crypto12381
                 );
             }(std::make_index_sequence<sizeof...(Args)>{});
         }
+
+        static constexpr bool has_lazy_values = (false || ... || detail::hoist_ns::has_lazy_values<Args>);
+
+        // the invocation with its lazy values evaluated, e.g. g ^ x in Σ[n](h[i] * (g ^ x))
+        template<class Self> requires has_lazy_values
+        constexpr auto hoist(this Self&& self)
+        {
+            return [&]<size_t...I>(std::index_sequence<I...>){
+                return symbolic_invocation<F, decltype(detail::hoist_ns::hoist_argument<Args>(std::get<I>(std::forward_like<Self>(self.args_))))...>{
+                    (F)std::get<0>(std::forward_like<Self>(self.fn_)),
+                    detail::hoist_ns::hoist_argument<Args>(std::get<I>(std::forward_like<Self>(self.args_)))...
+                };
+            }(std::index_sequence_for<Args...>{});
+        }
     private:
         std::tuple<F> fn_;
         std::tuple<Args...> args_;
@@ -615,7 +738,7 @@ namespace crypto12381
     public:
         algebraic_range() requires std::default_initializable<R> = default;
 
-        template<class T>
+        template<class T> requires (not std::same_as<std::remove_cvref_t<T>, algebraic_range>)
         constexpr algebraic_range(T&& base)
         noexcept(std::is_nothrow_constructible_v<R, T>)
         : base_{ (T&&)base }
@@ -675,6 +798,12 @@ namespace crypto12381
             return std::ranges::empty(base_);
         }
 
+        template<class Self, class...Args>
+        constexpr auto except(this Self&& self, Args&&...args)
+        {
+            return std::forward<Self>(self) | functors::except(std::forward<Args>(args)...);
+        }
+
         template<typename Self> requires std::ranges::random_access_range<R>
         constexpr decltype(auto) operator[](this Self&& self, std::ranges::range_difference_t<R> i)
         {
@@ -730,27 +859,64 @@ namespace crypto12381
         return symbolic_invoke(std::bit_xor<>{}, std::forward<L>(left), std::forward<R>(right));
     }
 
-    // namespace detail 
-    // {
-    //     struct zip_transform_fn : symbolic_functor_interface<zip_transform_fn>
-    //     {
-    //         using symbolic_functor_interface<zip_transform_fn>::operator();
-
-    //         template<not_symbolic F, not_symbolic...R>
-    //         static constexpr decltype(auto) operator()(F&& fn, R&&...ranges)
-    //         {
-    //             return std::views::zip_transform(
-    //                 (F&&)fn,
-    //                 (R&&)ranges | unwrap...
-    //             ) | algebraic;
-    //         }
-    //     };
-    // }
-
-    // inline namespace functors 
-    // {
-    //     inline constexpr detail::zip_transform_fn zip_transform{};
-    // }
+    namespace detail 
+    {
+        // throws std::runtime_error if the sized views have different lengths, instead of cutting them to the shortest
+        template<std::ranges::view...V>
+        constexpr void check_same_size(V&...views)
+        {
+            if constexpr((std::ranges::sized_range<V> && ...))
+            {
+                const std::array sizes{ static_cast<size_t>(std::ranges::size(views))... };
+                for(size_t size : sizes)
+                {
+                    if(size != sizes[0])
+                    {
+                        throw std::runtime_error{ "The zipped ranges have different lengths." };
+                    }
+                }
+            }
+        }
+
+        // the elements are computed on access, random access when all the ranges are, e.g. zip_transform(f, h, m)[k]
+        // takes h[k] and m[k] once each without materializing anything, a symbol among the arguments defers it
+        struct zip_transform_fn : symbolic_functor_interface<zip_transform_fn>
+        {
+            using symbolic_functor_interface<zip_transform_fn>::operator();
+
+            template<not_symbolic F, not_symbolic...R> requires (sizeof...(R) > 0)
+            static constexpr auto operator()(F&& fn, R&&...ranges)
+            {
+                return [&]<class...V>(V...views)
+                {
+                    check_same_size(views...);
+                    return std::views::zip_transform((F&&)fn, std::move(views)...) | algebraic;
+                }(unwrap_all((R&&)ranges)...);
+            }
+        };
+
+        // the tuples of the references to the elements, e.g. for(auto&& [a, z_] : zip(pub_a, z))
+        struct zip_fn : symbolic_functor_interface<zip_fn>
+        {
+            using symbolic_functor_interface<zip_fn>::operator();
+
+            template<not_symbolic...R> requires (sizeof...(R) > 0)
+            static constexpr auto operator()(R&&...ranges)
+            {
+                return [&]<class...V>(V...views)
+                {
+                    check_same_size(views...);
+                    return std::views::zip(std::move(views)...) | algebraic;
+                }(unwrap_all((R&&)ranges)...);
+            }
+        };
+    }
+
+    inline namespace functors 
+    {
+        inline constexpr detail::zip_transform_fn zip_transform{};
+        inline constexpr detail::zip_fn zip{};
+    }
 }
 
 #endif
@@ -0,0 +1,95 @@
+#ifndef CRYPTO12381_ARENA_HPP
+#define CRYPTO12381_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace crypto12381::detail
+{
+    // the resource of the innermost arena of the current thread
+    inline thread_local std::pmr::memory_resource* arena_resource = nullptr;
+
+    // the resource of the innermost arena of the current thread which also holds the returned ranges
+    inline thread_local std::pmr::memory_resource* result_arena_resource = nullptr;
+
+    // the arena of the current thread if there is one, else the default resource
+    inline std::pmr::memory_resource* scratch_resource() noexcept
+    {
+        return arena_resource != nullptr ? arena_resource : std::pmr::get_default_resource();
+    }
+
+    // the arena of the current thread if it holds the returned ranges, else the default resource
+    inline std::pmr::memory_resource* result_resource() noexcept
+    {
+        return result_arena_resource != nullptr ? result_arena_resource : std::pmr::get_default_resource();
+    }
+
+    // the buffers of products with scratch_resource(), and the materialized ranges with result_resource()
+    template<typename T>
+    using scratch_vector = std::pmr::vector<T>;
+}
+
+namespace crypto12381
+{
+    enum class arena_scope
+    {
+        // the buffers of the library, e.g. of products and hashes, the returned ranges take the default resource
+        temporaries,
+        // also the ranges returned by the library, e.g. by materialize, parse and encode_to,
+        // which must not outlive the arena
+        results
+    };
+
+    // a monotonic arena for the temporaries of crypto12381 on the current thread while it is alive,
+    // e.g. for a whole verification, whose memory is released at once when it ends
+    // the threads of a parallel policy other than the calling one still allocate on the heap
+    class Arena
+    {
+    public:
+        // chunks of the default resource, the first one of initial_size bytes
+        explicit Arena(size_t initial_size = 64uz * 1024uz, arena_scope scope = arena_scope::temporaries)
+        : resource_{ initial_size }
+        , previous_{ std::exchange(detail::arena_resource, &resource_) }
+        , previous_results_{ enter(scope) }
+        {}
+
+        // the bytes of buffer first, then chunks of the default resource when they are used up
+        explicit Arena(std::span<std::byte> buffer, arena_scope scope = arena_scope::temporaries)
+        : resource_{ buffer.data(), buffer.size() }
+        , previous_{ std::exchange(detail::arena_resource, &resource_) }
+        , previous_results_{ enter(scope) }
+        {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        // the arenas of a thread end in the reverse order of their construction
+        ~Arena()
+        {
+            detail::arena_resource = previous_;
+            detail::result_arena_resource = previous_results_;
+        }
+
+        std::pmr::memory_resource* resource() noexcept
+        {
+            return &resource_;
+        }
+
+    private:
+        std::pmr::memory_resource* enter(arena_scope scope) noexcept
+        {
+            return scope == arena_scope::results
+                ? std::exchange(detail::result_arena_resource, &resource_)
+                : detail::result_arena_resource;
+        }
+
+        std::pmr::monotonic_buffer_resource resource_;
+        std::pmr::memory_resource* previous_;
+        std::pmr::memory_resource* previous_results_;
+    };
+}
+
+#endif
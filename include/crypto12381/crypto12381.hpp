@@ -2,4 +2,5 @@
 #include "zp_number.hpp"
 #include "g1_point.hpp"
 #include "g2_point.hpp"
-#include "liner_pair.hpp"
\ No newline at end of file
+#include "liner_pair.hpp"
+#include "parse_cache.hpp"
\ No newline at end of file
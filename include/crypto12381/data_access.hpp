@@ -53,11 +53,16 @@ namespace crypto12381::detail
         template<ChunkRange, ChunkRange>
         friend class ZpNumber2;
 
+        template<size_t>
+        friend class ZpBounded;
+
         friend class G1Point;
 
         template<typename, typename>
         friend class G1Pow;
 
+        friend class G1ProductStream;
+
         friend class G2Point;
 
         friend class GTPoint;
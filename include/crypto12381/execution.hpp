@@ -0,0 +1,178 @@
+#ifndef CRYPTO12381_EXECUTION_HPP
+#define CRYPTO12381_EXECUTION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "explain.hpp"
+
+namespace crypto12381
+{
+    struct parallel_policy
+    {
+        // 0 for std::thread::hardware_concurrency()
+        size_t n_threads = 0;
+
+        constexpr parallel_policy operator()(size_t n) const noexcept
+        {
+            return parallel_policy{ n };
+        }
+
+        size_t thread_count() const noexcept
+        {
+            return n_threads != 0 ? n_threads : std::max(1u, std::thread::hardware_concurrency());
+        }
+    };
+
+    inline constexpr parallel_policy parallel{};
+}
+
+namespace crypto12381::detail
+{
+    // true on the threads of the pool and on a thread which runs the tasks of a parallel_for
+    inline thread_local bool in_parallel_for = false;
+
+    // the threads of the parallel policies, started on first use and kept for the later calls
+    class thread_pool
+    {
+    public:
+        static thread_pool& instance()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard lock{ mutex_ };
+                stopping_ = true;
+            }
+            ready_.notify_all();
+        }
+
+        // run task once on each of n threads of the pool, which grows to n threads if it is smaller
+        void run(size_t n, const std::function<void()>& task)
+        {
+            {
+                std::lock_guard lock{ mutex_ };
+                while(workers_.size() < n)
+                {
+                    workers_.emplace_back([this]{ serve(); });
+                }
+                tasks_.insert(tasks_.end(), n, task);
+            }
+            ready_.notify_all();
+        }
+
+    private:
+        thread_pool() = default;
+
+        void serve()
+        {
+            in_parallel_for = true;
+            std::unique_lock lock{ mutex_ };
+            while(true)
+            {
+                ready_.wait(lock, [this]{ return stopping_ || not tasks_.empty(); });
+                if(tasks_.empty())
+                {
+                    return;
+                }
+                const auto task = std::move(tasks_.front());
+                tasks_.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<std::function<void()>> tasks_;
+        bool stopping_ = false;
+        // the last member, so the workers are joined before the others are destroyed
+        std::vector<std::jthread> workers_;
+    };
+
+    // call task(i) for i in [n_tasks] on the threads of policy, the calling thread takes part
+    // a parallel_for called by a task of another runs on the thread of that task, so nesting never waits for the pool
+    // the first exception thrown by a task stops the remaining tasks and is rethrown
+    // the operations and allocations of the other threads are counted in the plan of the calling thread if it is explained
+    template<typename Task>
+    void parallel_for(size_t n_tasks, Task&& task, parallel_policy policy)
+    {
+        const size_t n_threads = in_parallel_for ? 1uz : std::min(policy.thread_count(), n_tasks);
+        std::atomic<size_t> next = 0;
+        std::exception_ptr exception;
+        std::once_flag exception_flag;
+        auto work = [&]()
+        {
+            for(size_t i = next++; i < n_tasks; i = next++)
+            {
+                try
+                {
+                    task(i);
+                }
+                catch(...)
+                {
+                    std::call_once(exception_flag, [&]{ exception = std::current_exception(); });
+                    next = n_tasks;
+                }
+            }
+        };
+
+        if(n_threads <= 1)
+        {
+            work();
+        }
+        else
+        {
+            EvaluationPlan* const plan = explained_plan;
+            std::vector<EvaluationPlan> worker_plans(plan != nullptr ? n_threads : 0uz);
+            std::atomic<size_t> next_worker = 1;
+            std::latch done{ (std::ptrdiff_t)(n_threads - 1) };
+            thread_pool::instance().run(n_threads - 1, [&]
+            {
+                const size_t worker = next_worker++;
+                if(plan != nullptr)
+                {
+                    // installs the counting resources over the ones of the worker until the work is done
+                    Explain explain;
+                    work();
+                    worker_plans[worker] = explain.plan();
+                }
+                else
+                {
+                    work();
+                }
+                done.count_down();
+            });
+
+            in_parallel_for = true;
+            work();
+            in_parallel_for = false;
+            done.wait();
+
+            for(const auto& worker_plan : worker_plans)
+            {
+                *plan += worker_plan;
+            }
+        }
+
+        if(exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+#endif
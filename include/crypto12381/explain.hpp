@@ -0,0 +1,253 @@
+#ifndef CRYPTO12381_EXPLAIN_HPP
+#define CRYPTO12381_EXPLAIN_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <utility>
+
+#include "arena.hpp"
+
+namespace crypto12381
+{
+    // the operations taken by an evaluation, as counted by an Explain
+    struct EvaluationPlan
+    {
+        // sums of products of G1 points, by pairs of points or by buckets, and their points
+        size_t multi_scalar_multiplications = 0;
+        size_t msm_points = 0;
+        // p1 * v1 + p2 * v2 at once, e.g. for the product of two powers or the pairs of a short sum of products
+        size_t double_multiplications = 0;
+        // a G1 or G2 point by a number, or a GT element to a power
+        size_t multiplications = 0;
+        // products of ranges of points, added by a tree in affine coordinates
+        size_t point_sums = 0;
+        size_t miller_loops = 0;
+        size_t final_exponentiations = 0;
+        // points and GT elements read from bytes, parses served by a ParseCache are not counted
+        size_t parses = 0;
+        size_t subgroup_checks = 0;
+        size_t hashes_to_curve = 0;
+        // the inversions in Zp and the batched ones of the trees of point sums, the inversions taken inside
+        // miracl core, e.g. to make a point affine for its serialization, a map to the curve or a pairing, are not counted
+        size_t Zp_and_batch_inversions = 0;
+        // the temporaries, e.g. the buffers of products, and the returned ranges, e.g. materialized ones
+        size_t allocations = 0;
+        size_t allocated_bytes = 0;
+
+        constexpr EvaluationPlan& operator+=(const EvaluationPlan& other) noexcept
+        {
+            multi_scalar_multiplications += other.multi_scalar_multiplications;
+            msm_points += other.msm_points;
+            double_multiplications += other.double_multiplications;
+            multiplications += other.multiplications;
+            point_sums += other.point_sums;
+            miller_loops += other.miller_loops;
+            final_exponentiations += other.final_exponentiations;
+            parses += other.parses;
+            subgroup_checks += other.subgroup_checks;
+            hashes_to_curve += other.hashes_to_curve;
+            Zp_and_batch_inversions += other.Zp_and_batch_inversions;
+            allocations += other.allocations;
+            allocated_bytes += other.allocated_bytes;
+            return *this;
+        }
+
+        friend constexpr bool operator==(const EvaluationPlan&, const EvaluationPlan&) = default;
+
+        // one line for each kind of operation which was taken, e.g. "multi-scalar multiplications: 1 (12 points)"
+        std::string report() const
+        {
+            std::string result;
+            auto line = [&](const char* name, size_t count)
+            {
+                if(count != 0)
+                {
+                    result += name;
+                    result += ": ";
+                    result += std::to_string(count);
+                    result += '\n';
+                }
+            };
+            if(multi_scalar_multiplications != 0)
+            {
+                result += "multi-scalar multiplications: " + std::to_string(multi_scalar_multiplications)
+                    + " (" + std::to_string(msm_points) + " points)\n";
+            }
+            line("double multiplications", double_multiplications);
+            line("multiplications", multiplications);
+            line("point sums", point_sums);
+            line("miller loops", miller_loops);
+            line("final exponentiations", final_exponentiations);
+            line("parses", parses);
+            line("subgroup checks", subgroup_checks);
+            line("hashes to curve", hashes_to_curve);
+            line("Zp and batch inversions", Zp_and_batch_inversions);
+            if(allocations != 0)
+            {
+                result += "allocations: " + std::to_string(allocations)
+                    + " (" + std::to_string(allocated_bytes) + " bytes)\n";
+            }
+            return result;
+        }
+    };
+}
+
+namespace crypto12381::detail
+{
+    // the plan of the innermost Explain of the current thread
+    inline thread_local EvaluationPlan* explained_plan = nullptr;
+
+    // count operations of the kind of member, if the current thread is explained
+    inline void note(size_t EvaluationPlan::* member, size_t count = 1uz) noexcept
+    {
+        if(explained_plan != nullptr)
+        {
+            explained_plan->*member += count;
+        }
+    }
+
+    // the resources the current thread would take for its temporaries and its results without an Explain
+    inline thread_local std::pmr::memory_resource* explained_upstream = nullptr;
+    inline thread_local std::pmr::memory_resource* explained_result_upstream = nullptr;
+
+    // counts the allocations in the explained plan of the current thread and passes them to the upstream of
+    // the thread, each allocation keeps its upstream in front of it, so a range made in the scope of
+    // an Explain is still released by the resource it came from after the Explain ends
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        // upstream() is the resource of the current thread, nullptr for the default resource
+        explicit counting_resource(std::pmr::memory_resource* (*upstream)() noexcept) noexcept
+        : upstream_{ upstream }
+        {}
+
+    private:
+        static constexpr size_t header_alignment = alignof(std::pmr::memory_resource*);
+
+        // the upstream pointer ends right before the returned bytes, which keep their alignment
+        static constexpr size_t header_size(size_t alignment) noexcept
+        {
+            return std::max(alignment, sizeof(std::pmr::memory_resource*));
+        }
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            std::pmr::memory_resource* upstream = upstream_() != nullptr
+                ? upstream_()
+                : std::pmr::get_default_resource();
+            note(&EvaluationPlan::allocations);
+            note(&EvaluationPlan::allocated_bytes, bytes);
+
+            const size_t header = header_size(alignment);
+            auto* start = static_cast<std::byte*>(
+                upstream->allocate(header + bytes, std::max(alignment, header_alignment))
+            );
+            std::memcpy(start + header - sizeof(upstream), &upstream, sizeof(upstream));
+            return start + header;
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            const size_t header = header_size(alignment);
+            auto* start = static_cast<std::byte*>(p) - header;
+            std::pmr::memory_resource* upstream;
+            std::memcpy(&upstream, start + header - sizeof(upstream), sizeof(upstream));
+            upstream->deallocate(start, header + bytes, std::max(alignment, header_alignment));
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* (*upstream_)() noexcept;
+    };
+
+    // single resources which outlive every Explain, for the temporaries and for the results
+    inline counting_resource& counting() noexcept
+    {
+        static counting_resource resource{ []() noexcept { return explained_upstream; } };
+        return resource;
+    }
+
+    inline counting_resource& result_counting() noexcept
+    {
+        static counting_resource resource{ []() noexcept { return explained_result_upstream; } };
+        return resource;
+    }
+}
+
+namespace crypto12381
+{
+    // counts the operations of crypto12381 on the current thread while it is alive, and on the threads of
+    // the parallel policies called from it, e.g. to check that Π[n](h[i] ^ m[i]) takes a single multi-scalar
+    // multiplication; the allocations in an Arena made inside of its scope are not counted
+    class Explain
+    {
+    public:
+        Explain() noexcept
+        : previous_plan_{ std::exchange(detail::explained_plan, &plan_) }
+        , previous_resource_{ detail::arena_resource }
+        , previous_result_resource_{ detail::result_arena_resource }
+        , previous_upstream_{ detail::explained_upstream }
+        , previous_result_upstream_{ detail::explained_result_upstream }
+        {
+            // an enclosing Explain has already installed the counting resources, unless an Arena replaced them
+            if(detail::arena_resource != &detail::counting())
+            {
+                detail::explained_upstream = detail::scratch_resource();
+                detail::arena_resource = &detail::counting();
+            }
+            if(detail::result_arena_resource != &detail::result_counting())
+            {
+                detail::explained_result_upstream = detail::result_resource();
+                detail::result_arena_resource = &detail::result_counting();
+            }
+        }
+
+        Explain(const Explain&) = delete;
+        Explain& operator=(const Explain&) = delete;
+
+        // an enclosing Explain counts the operations of this one too
+        ~Explain()
+        {
+            detail::arena_resource = previous_resource_;
+            detail::result_arena_resource = previous_result_resource_;
+            detail::explained_upstream = previous_upstream_;
+            detail::explained_result_upstream = previous_result_upstream_;
+            detail::explained_plan = previous_plan_;
+            if(previous_plan_ != nullptr)
+            {
+                *previous_plan_ += plan_;
+            }
+        }
+
+        const EvaluationPlan& plan() const noexcept
+        {
+            return plan_;
+        }
+
+    private:
+        EvaluationPlan plan_;
+        EvaluationPlan* previous_plan_;
+        std::pmr::memory_resource* previous_resource_;
+        std::pmr::memory_resource* previous_result_resource_;
+        std::pmr::memory_resource* previous_upstream_;
+        std::pmr::memory_resource* previous_result_upstream_;
+    };
+
+    // the plan of the evaluation of f(), whose result should be evaluated, e.g. a G1Point instead of the lazy g ^ x
+    template<typename F>
+    EvaluationPlan explain(F&& f)
+    {
+        Explain explain;
+        std::invoke(std::forward<F>(f));
+        return explain.plan();
+    }
+}
+
+#endif
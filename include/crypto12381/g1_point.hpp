@@ -1,9 +1,13 @@
 #ifndef CRYPTO12381_G1_POINT_HPP
 #define CRYPTO12381_G1_POINT_HPP
 
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <span>
 #include <stdexcept>
 #include <tuple>
+#include <vector>
 
 #include "miracl_core_interface.hpp"
 
@@ -18,6 +22,8 @@ namespace crypto12381
 
         template<typename P, typename V>
         class G1Pow;
+
+        class G1ProductStream;
     }
 
     template<typename T>
@@ -41,6 +47,12 @@ namespace crypto12381::detail::sets
             { t.G1_point() } -> detail::specified<detail::G1Point>;
         };
     }
+
+    template<typename T>
+    consteval bool contains(constant_t<G1u>, std::type_identity<T>) noexcept
+    {
+        return contains(constant<G1>, std::type_identity<T>{});
+    }
 }
 
 namespace crypto12381::detail
@@ -49,12 +61,26 @@ namespace crypto12381::detail
     concept g1_reusable = std::is_object_v<decltype(std::declval<T>().G1_point())> || 
             std::is_rvalue_reference_v<decltype(std::declval<T>().G1_point())>;
 
+    template<typename T>
+    inline constexpr bool is_g1_pow = false;
+
+    template<typename P, typename V>
+    inline constexpr bool is_g1_pow<G1Pow<P, V>> = true;
+
+    template<typename T>
+    concept g1_pow = is_g1_pow<std::remove_cvref_t<T>>;
+
     struct G1PointData
     {
         miracl_core::point1 ecp;
 
+        // the prefix 0x02 or 0x03 of the bytes ecp was parsed from, 0 once ecp is converted to a non-const reference,
+        // so the operations which only read ecp take ecp itself; a parsed ecp is affine, so serialize only writes x
+        char prefix = 0;
+
         constexpr operator miracl_core::point1&()
         {
+            prefix = 0;
             return ecp;
         }
 
@@ -64,22 +90,6 @@ namespace crypto12381::detail
         }
     };
 
-    inline constexpr ZpNumberData modulus_data = {
-        0x1FEFFFFFFFFAAABL,
-        0x2FFFFAC54FFFFEEL,
-        0x12A0F6B0F6241EAL,
-        0x213CE144AFD9CC3L,
-        0x2434BACD764774BL,
-        0x25FF9A692C6E9EDL,
-        0x1A0111EA3L
-    };
-
-    constexpr ZpNumberData& modulus() noexcept
-    {
-        thread_local constinit auto modulus = modulus_data;
-        return modulus;
-    }
-
     class G1Point
     {
         friend DataAccessor;
@@ -92,14 +102,30 @@ namespace crypto12381::detail
                 return;
             }
 
-            serialized_field<G1> buffer;
-            std::memcpy(buffer.data(), bytes.data(), serialized_size<G1>);
+            if((bytes.front() != 0x02 && bytes.front() != 0x03) || miracl_core::decompress(data_, bytes.data()) != 1)
+            {
+                throw std::runtime_error{ "Failed to deserialize G1 point." };
+            }
+
+            data_.prefix = bytes.front();
+        }
+
+        constexpr explicit G1Point(serialized_view<G1u> bytes)
+        {
+            if(bytes.front() == 0)
+            {
+                miracl_core::get_infinity(data_);
+                return;
+            }
+
+            serialized_field<G1u> buffer;
+            std::memcpy(buffer.data(), bytes.data(), serialized_size<G1u>);
             miracl_core::bytes_view buffer_view{
-                .len = serialized_size<G1>,
-                .max = serialized_size<G1>,
+                .len = serialized_size<G1u>,
+                .max = serialized_size<G1u>,
                 .data = buffer.data()
             };
-            if(miracl_core::from_bytes(data_, buffer_view) != 1)
+            if(bytes.front() != 0x04 || miracl_core::from_bytes(data_, buffer_view) != 1)
             {
                 throw std::runtime_error{ "Failed to deserialize G1 point." };
             }
@@ -110,6 +136,13 @@ namespace crypto12381::detail
 
         void serialize(std::span<char, serialized_size<G1>> bytes) const noexcept
         {
+            if(data_.prefix != 0)
+            {
+                bytes.front() = data_.prefix;
+                miracl_core::affine_x_to_bytes(bytes.data() + 1, data_.ecp);
+                return;
+            }
+
             if(miracl_core::is_infinity(data_))
             {
                 std::memset(bytes.data(), 0, serialized_size<G1>);
@@ -124,6 +157,28 @@ namespace crypto12381::detail
             miracl_core::to_bytes(buffer_view, auto{ data_ }, true);
         }
 
+        void serialize(std::span<char, serialized_size<G1u>> bytes) const noexcept
+        {
+            if(miracl_core::is_infinity(data_))
+            {
+                std::memset(bytes.data(), 0, serialized_size<G1u>);
+                return;
+            }
+
+            miracl_core::bytes_view buffer_view{
+                .len = 0,
+                .max = serialized_size<G1u>,
+                .data = bytes.data()
+            };
+            miracl_core::to_bytes(buffer_view, auto{ data_ }, false);
+        }
+
+        // whether the point is in the subgroup of order r, parse only checks that it is on the curve
+        bool is_in_subgroup() const noexcept
+        {
+            return miracl_core::is_in_subgroup(auto{ data_ });
+        }
+
         template<typename Self>
         constexpr decltype(auto) G1_point(this Self&& self) noexcept
         {
@@ -170,19 +225,19 @@ namespace crypto12381::detail
             if constexpr(g1_reusable<L>)
             {
                 decltype(auto) result = l.G1_point();
-                miracl_core::add(result.data_, r.G1_point().data_);
+                miracl_core::add(result.data_, r.G1_point().data_.ecp);
                 return result;
             }
             else if constexpr(g1_reusable<R>)
             {
                 decltype(auto) result = r.G1_point();
-                miracl_core::add(result.data_, l.G1_point().data_);
+                miracl_core::add(result.data_, l.G1_point().data_.ecp);
                 return result;
             }
             else
             {
                 G1Point result = l.G1_point();
-                miracl_core::add(result.data_, r.G1_point().data_);
+                miracl_core::add(result.data_, r.G1_point().data_.ecp);
                 return result;
             }
         }
@@ -193,13 +248,13 @@ namespace crypto12381::detail
             if constexpr(g1_reusable<L>)
             {
                 decltype(auto) result = l.G1_point();
-                miracl_core::sub(result.data_, r.G1_point().data_);
+                miracl_core::sub(result.data_, r.G1_point().data_.ecp);
                 return result;
             }
             else
             {
                 G1Point result = l.G1_point();
-                miracl_core::sub(result.data_, r.G1_point().data_);
+                miracl_core::sub(result.data_, r.G1_point().data_.ecp);
                 return result;
             }
         }
@@ -213,44 +268,116 @@ namespace crypto12381::detail
         template<G1_element L, G1_element R>
         friend constexpr bool operator==(L&& l, R&& r) noexcept
         {
-            return miracl_core::equal(data(l.G1_point()), data(r.G1_point())) == 1;
+            return miracl_core::equal(data(l.G1_point()).ecp, data(r.G1_point()).ecp) == 1;
         }
 
-        static G1Point from_hash(hash_state&& state) noexcept
+        template<typename Hash>
+        static G1Point from_hash(basic_hash_state<Hash>&& state) noexcept
         {
-            char hash_bytes[hash_state::hash_size];
-            std::move(state).to(hash_bytes);
-            miracl_core::big2 dbig;
-            miracl_core::from_bytes(dbig, hash_bytes, hash_state::hash_size);
-            miracl_core::big x;
-            miracl_core::fixed_time_mod(x, dbig, modulus(), hash_state::hash_size * 8 - 381);
-            miracl_core::fp fp;
-            miracl_core::residue(fp, x);
-
+            miracl_core::fp fp = digest_residue(std::move(state));
             G1Point result;
-            miracl_core::map_to_point(result.data_, fp);
-            miracl_core::multiply_cofactor(result.data_);
+            miracl_core::map_to_points(&result.data_.ecp, 1, &fp);
             return result;
         }
 
+        // the states of a range hashed at once, the map shares its constants between them
+        template<std::ranges::range R>
+        static scratch_vector<G1Point> from_hashes(R&& states)
+        {
+            scratch_vector<miracl_core::fp> values{ scratch_resource() };
+            for(auto&& state : std::forward<R>(states))
+            {
+                values.push_back(digest_residue(take_hash_state<R>(state)));
+            }
+            scratch_vector<miracl_core::point1> points(values.size(), scratch_resource());
+            miracl_core::map_to_points(points.data(), points.size(), values.data());
+
+            scratch_vector<G1Point> results{ result_resource() };
+            results.reserve(points.size());
+            for(auto& point : points)
+            {
+                G1Point result;
+                result.data_.ecp = point;
+                results.push_back(std::move(result));
+            }
+            return results;
+        }
+
         template<std::ranges::range R> 
         requires specified<std::ranges::range_value_t<R>, G1Point>
         friend constexpr auto product(std::type_identity<G1Point>, R&& r) 
         {
-            G1Point result;
-            miracl_core::get_infinity(result.data_);
+            // the long ranges of affine points, e.g. parsed ones, take a tree of affine additions
+            scratch_vector<miracl_core::point1> points{ scratch_resource() };
             for(auto&& p : std::forward<R>(r))
             {
-                miracl_core::add(result.data_, p.G1_point().data_);
+                points.push_back(p.G1_point().data_.ecp);
             }
+            G1Point result;
+            miracl_core::sum(result.data_, points.size(), points.data());
             return result;
         }
 
+        // {points ^ number...} with number recoded once for all points, e.g. auto [U1, U2] = pow_all(x, T1, T2)
+        template<Zp_element V, G1_element...P> requires (sizeof...(P) > 0)
+        friend std::array<G1Point, sizeof...(P)> pow_all(V&& number, P&&...points)
+        {
+            std::array<G1Point, sizeof...(P)> results{ G1Point{ std::forward<P>(points).G1_point() }... };
+            multiply_all(results, std::forward<V>(number));
+            return results;
+        }
+
+        template<Zp_element V, std::ranges::range R> requires G1_element<std::ranges::range_reference_t<R>>
+        friend auto pow_all(V&& number, R&& points)
+        {
+            scratch_vector<G1Point> results{ result_resource() };
+            for(auto&& point : std::forward<R>(points))
+            {
+                results.push_back(G1Point{ point.G1_point() });
+            }
+            multiply_all(results, std::forward<V>(number));
+            return std::move(results) | algebraic;
+        }
+
     private:
         constexpr G1Point() noexcept = default;
 
         G1Point& operator=(const G1Point&) = default;
         G1Point& operator=(G1Point&&) = default;
+
+        // the public numbers take the variable time algorithm for each point
+        template<typename N>
+        static void multiply_all(std::span<G1Point> points, N&& number)
+        {
+            if constexpr(public_Zp_element<N>)
+            {
+                for(auto& point : points)
+                {
+                    miracl_core::multiply_vartime(point.data_, data(number.Zp_number()));
+                }
+            }
+            else
+            {
+                scratch_vector<miracl_core::point1> values{ scratch_resource() };
+                values.reserve(points.size());
+                for(auto& point : points)
+                {
+                    values.push_back(point.data_.ecp);
+                }
+                if constexpr(bounded_Zp_element<N>)
+                {
+                    miracl_core::multiply_bounded(values.data(), values.size(), data(number.Zp_number()), std::remove_cvref_t<N>::n_bits);
+                }
+                else
+                {
+                    miracl_core::multiply(values.data(), values.size(), data(number.Zp_number()));
+                }
+                for(size_t i = 0; i < points.size(); ++i)
+                {
+                    points[i].data_ = G1PointData{ values[i] };
+                }
+            }
+        }
         
         static G1Point& get_default_generator() noexcept
         {
@@ -275,6 +402,7 @@ namespace crypto12381::detail
     class G1Pow
     {
         friend G1Point;
+        friend G1ProductStream;
         friend DataAccessor;
         template<typename, typename>
         friend class G1Pow;
@@ -292,19 +420,26 @@ namespace crypto12381::detail
             return std::forward<Self>(self).G1_point();
         }
 
+        // evaluated once for all the elements of Σ or Π, in which it does not depend on the symbol
+        template<specified<G1Pow> Self>
+        friend G1Point hoist(Self&& self) noexcept
+        {
+            return std::forward<Self>(self).G1_point();
+        }
+
         template<typename Self>
         constexpr G1Point G1_point(this Self&& self) noexcept
         {
             if constexpr(std::is_rvalue_reference_v<decltype(std::forward<Self>(self).point())>)
             {
                 decltype(auto) result = std::forward<Self>(self).point().G1_point();
-                miracl_core::multiply(data(result), data(std::forward<Self>(self).number().Zp_number()));
+                multiply_by(data(result), std::forward<Self>(self).number());
                 return result;
             }
             else
             {
                 G1Point result = std::forward<Self>(self).point().G1_point();
-                miracl_core::multiply(data(result), data(std::forward<Self>(self).number().Zp_number()));
+                multiply_by(data(result), std::forward<Self>(self).number());
                 return result;
             }
         }
@@ -320,33 +455,33 @@ namespace crypto12381::detail
             if constexpr(g1_reusable<decltype(std::forward<L>(l).point())>)
             {
                 decltype(auto) result = std::forward<L>(l).point().G1_point();
-                miracl_core::double_multiply(
+                double_multiply_by(
                     data(result), 
                     data(std::forward<R>(r).point().G1_point()), 
-                    data(std::forward<L>(l).number().Zp_number()),
-                    data(std::forward<R>(r).number().Zp_number())
+                    std::forward<L>(l).number(),
+                    std::forward<R>(r).number()
                 );
                 return result;
             }
             else if constexpr(g1_reusable<decltype(std::forward<R>(r).point())>)
             {
                 decltype(auto) result = std::forward<R>(r).point().G1_point();
-                miracl_core::double_multiply(
+                double_multiply_by(
                     data(result), 
                     data(std::forward<L>(l).point().G1_point()), 
-                    data(std::forward<R>(r).number().Zp_number()),
-                    data(std::forward<L>(l).number().Zp_number())
+                    std::forward<R>(r).number(),
+                    std::forward<L>(l).number()
                 );
                 return result;
             }
             else
             {
                 G1Point result = std::forward<L>(l).point().G1_point();
-                miracl_core::double_multiply(
+                double_multiply_by(
                     data(result), 
                     data(std::forward<R>(r).point().G1_point()), 
-                    data(std::forward<L>(l).number().Zp_number()),
-                    data(std::forward<R>(r).number().Zp_number())
+                    std::forward<L>(l).number(),
+                    std::forward<R>(r).number()
                 );
                 return result;
             }
@@ -373,33 +508,26 @@ namespace crypto12381::detail
         friend constexpr auto product(std::type_identity<G1Pow>, R&& r) 
         {
             auto result = data.create<G1Point>();
-            
-            // const size_t n = std::ranges::size(r);
-            // std::vector<miracl_core::point1> points(n);
-            // std::vector<ZpNumberData>        numbers(n);
-
-            // for(auto&&[point, number, pow] : std::views::zip(points, numbers, r))
-            // {
-            //     point = data(pow.point().G1_point());
-            //     number = data(pow.number().Zp_number());
-            // }
 
-            // miracl_core::sum_of_products(data(result), n, points.data(), (miracl_core::big*)numbers.data());
-
-            miracl_core::get_infinity(data(result));
-
-            const auto sentinel = std::ranges::end(r);
-            for(auto iter = std::ranges::begin(r); iter != sentinel; ++iter)
+            scratch_vector<miracl_core::point1> points{ scratch_resource() };
+            scratch_vector<ZpNumberData>        numbers{ scratch_resource() };
+            for(auto&& pow : std::forward<R>(r))
             {
-                auto iter_prev = iter++;
-                if(iter == sentinel)
-                {
-                    miracl_core::add(data(result), data((*iter_prev).G1_point()));
-                    break;
-                }
-                miracl_core::add(data(result), data((*iter_prev * *iter)));
+                points.push_back(data(pow.point().G1_point()));
+                numbers.push_back(data(pow.number().Zp_number()));
             }
 
+            using number_t = decltype(std::declval<std::ranges::range_reference_t<R>>().number());
+            if constexpr(public_Zp_element<number_t>)
+            {
+                miracl_core::sum_of_products_vartime(data(result), points.size(), points.data(), (const miracl_core::big*)numbers.data());
+            }
+            else
+            {
+                // the secret numbers take the constant time buckets
+                constexpr int n_bits = Zp_bound_bits<std::remove_cvref_t<number_t>>;
+                miracl_core::sum_of_products(data(result), points.size(), points.data(), (const miracl_core::big*)numbers.data(), n_bits);
+            }
             return result;
         }
     private:
@@ -407,6 +535,42 @@ namespace crypto12381::detail
         : data_{ std::forward<P>(point), std::forward<V>(number) }
         {}
 
+        // the public numbers take the variable time algorithms, the bounded numbers the shorter windows
+        template<typename N>
+        static void multiply_by(miracl_core::point1& point, N&& number) noexcept
+        {
+            if constexpr(public_Zp_element<N>)
+            {
+                miracl_core::multiply_vartime(point, data(std::forward<N>(number).Zp_number()));
+            }
+            else if constexpr(bounded_Zp_element<N>)
+            {
+                miracl_core::multiply_bounded(point, data(std::forward<N>(number).Zp_number()), std::remove_cvref_t<N>::n_bits);
+            }
+            else
+            {
+                miracl_core::multiply(point, data(std::forward<N>(number).Zp_number()));
+            }
+        }
+
+        template<typename N1, typename N2>
+        static void double_multiply_by(miracl_core::point1& p1, miracl_core::point1& p2, N1&& v1, N2&& v2) noexcept
+        {
+            if constexpr(public_Zp_element<N1> && public_Zp_element<N2>)
+            {
+                miracl_core::double_multiply_vartime(p1, p2, data(std::forward<N1>(v1).Zp_number()), data(std::forward<N2>(v2).Zp_number()));
+            }
+            else if constexpr(bounded_Zp_element<N1> && bounded_Zp_element<N2>)
+            {
+                constexpr int n_bits = std::max(std::remove_cvref_t<N1>::n_bits, std::remove_cvref_t<N2>::n_bits);
+                miracl_core::double_multiply_bounded(p1, p2, data(std::forward<N1>(v1).Zp_number()), data(std::forward<N2>(v2).Zp_number()), n_bits);
+            }
+            else
+            {
+                miracl_core::double_multiply(p1, p2, data(std::forward<N1>(v1).Zp_number()), data(std::forward<N2>(v2).Zp_number()));
+            }
+        }
+
         template<typename Self>
         constexpr decltype(auto) point(this Self&& self) noexcept
         {
@@ -422,11 +586,113 @@ namespace crypto12381::detail
         std::tuple<P, V> data_;
     };
 
+    // Π(points[i] ^ numbers[i]) accumulated from chunks of powers, e.g. of h vectors too long to materialize at once
+    // only the buckets of the windows and the current chunk are kept in memory
+    class G1ProductStream
+    {
+    public:
+        // n is the expected number of powers to choose the windows, all numbers must be less than 2^n_bits
+        explicit G1ProductStream(size_t n, int n_bits = Zp_number_bits)
+        : buckets_{ n, n_bits }
+        {}
+
+        template<g1_pow Pow>
+        G1ProductStream& add(Pow&& power)
+        {
+            using number_t = decltype(std::forward<Pow>(power).number());
+            clear_chunk<number_t>();
+            points_.push_back(data(std::forward<Pow>(power).point().G1_point()));
+            numbers_.push_back(data(std::forward<Pow>(power).number().Zp_number()));
+            add_chunk<number_t>();
+            return *this;
+        }
+
+        template<std::ranges::range R> requires g1_pow<std::ranges::range_reference_t<R>>
+        G1ProductStream& add(R&& powers)
+        {
+            using number_t = decltype(std::declval<std::ranges::range_reference_t<R>>().number());
+            clear_chunk<number_t>();
+            for(auto&& power : std::forward<R>(powers))
+            {
+                points_.push_back(data(power.point().G1_point()));
+                numbers_.push_back(data(power.number().Zp_number()));
+            }
+            add_chunk<number_t>();
+            return *this;
+        }
+
+        template<std::ranges::range P, std::ranges::range N> 
+        requires G1_element<std::ranges::range_reference_t<P>> && Zp_element<std::ranges::range_reference_t<N>>
+        G1ProductStream& add(P&& points, N&& numbers)
+        {
+            using number_t = std::ranges::range_reference_t<N>;
+            clear_chunk<number_t>();
+            for(auto&& point : std::forward<P>(points))
+            {
+                points_.push_back(data(point.G1_point()));
+            }
+            for(auto&& number : std::forward<N>(numbers))
+            {
+                numbers_.push_back(data(number.Zp_number()));
+            }
+            if(points_.size() != numbers_.size())
+            {
+                throw std::runtime_error{ "The chunk has different numbers of points and numbers." };
+            }
+            add_chunk<number_t>();
+            return *this;
+        }
+
+        // the product of all powers added so far, more chunks can still be added
+        G1Point result() const noexcept
+        {
+            auto result = data.create<G1Point>();
+            buckets_.finish(data(result));
+            return result;
+        }
+
+    private:
+        template<typename N>
+        void clear_chunk()
+        {
+            if(Zp_bound_bits<std::remove_cvref_t<N>> > buckets_.bit_count())
+            {
+                throw std::runtime_error{ "The numbers have more bits than the product stream." };
+            }
+            points_.clear();
+            numbers_.clear();
+        }
+
+        // the public numbers index the buckets directly, the secret numbers take the constant time additions
+        template<typename N>
+        void add_chunk() noexcept
+        {
+            if constexpr(public_Zp_element<N>)
+            {
+                buckets_.add_vartime(points_.size(), points_.data(), (const miracl_core::big*)numbers_.data());
+            }
+            else
+            {
+                buckets_.add(points_.size(), points_.data(), (const miracl_core::big*)numbers_.data());
+            }
+        }
+
+        miracl_core::product_buckets      buckets_;
+        std::vector<miracl_core::point1> points_;
+        std::vector<ZpNumberData>        numbers_;
+    };
+
     template<G1_element T>
     constexpr void serialize_to(std::span<char, serialized_size<G1>> bytes, T&& t)
     {
         std::forward<T>(t).G1_point().serialize(bytes);
     }
+
+    template<G1_element T>
+    constexpr void serialize_to(std::span<char, serialized_size<G1u>> bytes, encoded_as<constant_t<G1u>, T> t)
+    {
+        std::forward<T>(t.value).G1_point().serialize(bytes);
+    }
 }
 
 namespace crypto12381::detail::sets 
@@ -446,10 +712,27 @@ namespace crypto12381::detail::sets
         return detail::G1Point{ bytes };
     }
 
-    inline auto hash_to(hash_state&& state, G1_t) noexcept
+    constexpr auto parse(constant_t<G1u>, serialized_view<G1u> bytes)
+    {
+        return detail::G1Point{ bytes };
+    }
+
+    template<typename Hash>
+    inline auto hash_to(basic_hash_state<Hash>&& state, G1_t) noexcept
     {
         return G1Point::from_hash(std::move(state));
     }
+
+    template<std::ranges::range R> requires hash_state_of<std::ranges::range_value_t<R>>
+    inline auto hash_to_each(R&& states, G1_t)
+    {
+        return G1Point::from_hashes(std::forward<R>(states));
+    }
+}
+
+namespace crypto12381
+{
+    using G1ProductStream = detail::G1ProductStream;
 }
 
 #endif
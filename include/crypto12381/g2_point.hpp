@@ -1,9 +1,12 @@
 #ifndef CRYPTO12381_G2_POINT_HPP
 #define CRYPTO12381_G2_POINT_HPP
 
+#include <array>
 #include <cstring>
+#include <span>
 #include <stdexcept>
 #include <tuple>
+#include <vector>
 
 #include "miracl_core_interface.hpp"
 
@@ -41,6 +44,12 @@ namespace crypto12381::detail::sets
             { t.G2_point() } -> detail::specified<detail::G2Point>;
         };
     }
+
+    template<typename T>
+    consteval bool contains(constant_t<G2u>, std::type_identity<T>) noexcept
+    {
+        return contains(constant<G2>, std::type_identity<T>{});
+    }
 }
 
 namespace crypto12381::detail
@@ -53,8 +62,13 @@ namespace crypto12381::detail
     {
         miracl_core::point2 ecp;
 
+        // the prefix 0x02 or 0x03 of the bytes ecp was parsed from, 0 once ecp is converted to a non-const reference,
+        // so the operations which only read ecp take ecp itself; a parsed ecp is affine, so serialize only writes x
+        char prefix = 0;
+
         constexpr operator miracl_core::point2&() noexcept
         {
+            prefix = 0;
             return ecp;
         }
 
@@ -76,14 +90,30 @@ namespace crypto12381::detail
                 return;
             }
 
-            serialized_field<G2> buffer;
-            std::memcpy(buffer.data(), bytes.data(), serialized_size<G2>);
+            if((bytes.front() != 0x02 && bytes.front() != 0x03) || miracl_core::decompress(data_, bytes.data()) != 1)
+            {
+                throw std::runtime_error{ "Failed to deserialize G2 point." };
+            }
+
+            data_.prefix = bytes.front();
+        }
+
+        constexpr explicit G2Point(serialized_view<G2u> bytes)
+        {
+            if(bytes.front() == 0)
+            {
+                miracl_core::get_infinity(data_);
+                return;
+            }
+
+            serialized_field<G2u> buffer;
+            std::memcpy(buffer.data(), bytes.data(), serialized_size<G2u>);
             miracl_core::bytes_view buffer_view{
-                .len = serialized_size<G2>,
-                .max = serialized_size<G2>,
+                .len = serialized_size<G2u>,
+                .max = serialized_size<G2u>,
                 .data = buffer.data()
             };
-            if(miracl_core::from_bytes(data_, buffer_view) != 1)
+            if(bytes.front() != 0x04 || miracl_core::from_bytes(data_, buffer_view) != 1)
             {
                 throw std::runtime_error{ "Failed to deserialize G2 point." };
             }
@@ -94,6 +124,13 @@ namespace crypto12381::detail
 
         void serialize(std::span<char, serialized_size<G2>> bytes) const noexcept
         {
+            if(data_.prefix != 0)
+            {
+                bytes.front() = data_.prefix;
+                miracl_core::affine_x_to_bytes(bytes.data() + 1, data_.ecp);
+                return;
+            }
+
             if(miracl_core::is_infinity(data_))
             {
                 std::memset(bytes.data(), 0, serialized_size<G2>);
@@ -108,6 +145,28 @@ namespace crypto12381::detail
             miracl_core::to_bytes(buffer_view, auto{ data_ }, true);
         }
 
+        void serialize(std::span<char, serialized_size<G2u>> bytes) const noexcept
+        {
+            if(miracl_core::is_infinity(data_))
+            {
+                std::memset(bytes.data(), 0, serialized_size<G2u>);
+                return;
+            }
+
+            miracl_core::bytes_view buffer_view{
+                .len = 0,
+                .max = serialized_size<G2u>,
+                .data = bytes.data()
+            };
+            miracl_core::to_bytes(buffer_view, auto{ data_ }, false);
+        }
+
+        // whether the point is in the subgroup of order r, parse only checks that it is on the curve
+        bool is_in_subgroup() const noexcept
+        {
+            return miracl_core::is_in_subgroup(auto{ data_ });
+        }
+
         template<typename Self>
         constexpr decltype(auto) G2_point(this Self&& self) noexcept
         {
@@ -165,19 +224,19 @@ namespace crypto12381::detail
             if constexpr(g2_reusable<L>)
             {
                 decltype(auto) result = l.G2_point();
-                miracl_core::add(result.data_, r.G2_point().data_);
+                miracl_core::add(result.data_, r.G2_point().data_.ecp);
                 return result;
             }
             else if constexpr(g2_reusable<R>)
             {
                 decltype(auto) result = r.G2_point();
-                miracl_core::add(result.data_, l.G2_point().data_);
+                miracl_core::add(result.data_, l.G2_point().data_.ecp);
                 return result;
             }
             else
             {
                 G2Point result = l.G2_point();
-                miracl_core::add(result.data_, r.G2_point().data_);
+                miracl_core::add(result.data_, r.G2_point().data_.ecp);
                 return result;
             }
         }
@@ -188,13 +247,13 @@ namespace crypto12381::detail
             if constexpr(g2_reusable<L>)
             {
                 decltype(auto) result = l.G2_point();
-                miracl_core::sub(result.data_, r.G2_point().data_);
+                miracl_core::sub(result.data_, r.G2_point().data_.ecp);
                 return result;
             }
             else
             {
                 G2Point result = l.G2_point();
-                miracl_core::sub(result.data_, r.G2_point().data_);
+                miracl_core::sub(result.data_, r.G2_point().data_.ecp);
                 return result;
             }
         }
@@ -205,13 +264,13 @@ namespace crypto12381::detail
             if constexpr(g2_reusable<P>)
             {
                 decltype(auto) result = point.G2_point();
-                miracl_core::multiply(result.data_, data(number.Zp_number()));
+                multiply_by(result.data_, number);
                 return result;
             }
             else
             {
                 auto result = point.G2_point();
-                miracl_core::multiply(result.data_, data(number.Zp_number()));
+                multiply_by(result.data_, number);
                 return result;
             }
         }
@@ -219,27 +278,145 @@ namespace crypto12381::detail
         template<G2_element L, G2_element R>
         friend constexpr bool operator==(L&& l, R&& r) noexcept
         {
-            return miracl_core::equal(data(l.G2_point()), data(r.G2_point())) == 1;
+            return miracl_core::equal(data(l.G2_point()).ecp, data(r.G2_point()).ecp) == 1;
+        }
+
+        template<typename Hash>
+        static G2Point from_hash(basic_hash_state<Hash>&& state) noexcept
+        {
+            miracl_core::fp2 value = digest_residue2(std::move(state));
+            G2Point result;
+            miracl_core::map_to_points(&result.data_.ecp, 1, &value);
+            return result;
+        }
+
+        // the states of a range hashed at once, the cofactor clearing shares its constant between them
+        template<std::ranges::range R>
+        static scratch_vector<G2Point> from_hashes(R&& states)
+        {
+            scratch_vector<miracl_core::fp2> values{ scratch_resource() };
+            for(auto&& state : std::forward<R>(states))
+            {
+                values.push_back(digest_residue2(take_hash_state<R>(state)));
+            }
+            scratch_vector<miracl_core::point2> points(values.size(), scratch_resource());
+            miracl_core::map_to_points(points.data(), points.size(), values.data());
+
+            scratch_vector<G2Point> results{ result_resource() };
+            results.reserve(points.size());
+            for(auto& point : points)
+            {
+                G2Point result;
+                result.data_.ecp = point;
+                results.push_back(std::move(result));
+            }
+            return results;
         }
 
         template<std::ranges::range R> 
         requires specified<std::ranges::range_value_t<R>, G2Point>
         friend constexpr auto product(std::type_identity<G2Point>, R&& r) 
         {
-            G2Point result;
-            miracl_core::get_infinity(result.data_);
+            // the long ranges of affine points, e.g. parsed ones, take a tree of affine additions
+            scratch_vector<miracl_core::point2> points{ scratch_resource() };
             for(auto&& p : std::forward<R>(r))
             {
-                miracl_core::add(result.data_, p.G2_point().data_);
+                points.push_back(p.G2_point().data_.ecp);
             }
+            G2Point result;
+            miracl_core::sum(result.data_, points.size(), points.data());
             return result;
         }
 
+        // {points ^ number...} with number recoded once for all points, e.g. auto [U1, U2] = pow_all(x, T1, T2)
+        template<Zp_element V, G2_element...P> requires (sizeof...(P) > 0)
+        friend std::array<G2Point, sizeof...(P)> pow_all(V&& number, P&&...points)
+        {
+            std::array<G2Point, sizeof...(P)> results{ G2Point{ std::forward<P>(points).G2_point() }... };
+            multiply_all(results, std::forward<V>(number));
+            return results;
+        }
+
+        template<Zp_element V, std::ranges::range R> requires G2_element<std::ranges::range_reference_t<R>>
+        friend auto pow_all(V&& number, R&& points)
+        {
+            scratch_vector<G2Point> results{ result_resource() };
+            for(auto&& point : std::forward<R>(points))
+            {
+                results.push_back(G2Point{ point.G2_point() });
+            }
+            multiply_all(results, std::forward<V>(number));
+            return std::move(results) | algebraic;
+        }
+
     private:
         constexpr G2Point() noexcept = default;
 
         G2Point& operator=(const G2Point&) = default;
         G2Point& operator=(G2Point&&) = default;
+
+        // the two coordinates in Fp2 from the digests of state followed by 0 and by 1
+        template<typename Hash>
+        static miracl_core::fp2 digest_residue2(basic_hash_state<Hash>&& state) noexcept
+        {
+            auto imaginary = state.fork();
+            return miracl_core::fp2{
+                digest_residue(std::move(state) | char{ 0 }),
+                digest_residue(std::move(imaginary) | char{ 1 })
+            };
+        }
+
+        // the public numbers take the variable time algorithm for each point
+        template<typename N>
+        static void multiply_all(std::span<G2Point> points, N&& number)
+        {
+            if constexpr(public_Zp_element<N>)
+            {
+                for(auto& point : points)
+                {
+                    miracl_core::multiply_vartime(point.data_, data(number.Zp_number()));
+                }
+            }
+            else
+            {
+                scratch_vector<miracl_core::point2> values{ scratch_resource() };
+                values.reserve(points.size());
+                for(auto& point : points)
+                {
+                    values.push_back(point.data_.ecp);
+                }
+                if constexpr(bounded_Zp_element<N>)
+                {
+                    miracl_core::multiply_bounded(values.data(), values.size(), data(number.Zp_number()), std::remove_cvref_t<N>::n_bits);
+                }
+                else
+                {
+                    miracl_core::multiply(values.data(), values.size(), data(number.Zp_number()));
+                }
+                for(size_t i = 0; i < points.size(); ++i)
+                {
+                    points[i].data_ = G2PointData{ values[i] };
+                }
+            }
+        }
+
+        // the public numbers take the variable time algorithm, the bounded numbers the shorter windows
+        template<typename N>
+        static void multiply_by(miracl_core::point2& point, N&& number) noexcept
+        {
+            if constexpr(public_Zp_element<N>)
+            {
+                miracl_core::multiply_vartime(point, data(number.Zp_number()));
+            }
+            else if constexpr(bounded_Zp_element<N>)
+            {
+                miracl_core::multiply_bounded(point, data(number.Zp_number()), std::remove_cvref_t<N>::n_bits);
+            }
+            else
+            {
+                miracl_core::multiply(point, data(number.Zp_number()));
+            }
+        }
         
         static G2Point& get_default_generator() noexcept
         {
@@ -261,6 +438,12 @@ namespace crypto12381::detail
     {
         std::forward<T>(t).G2_point().serialize(bytes);
     }
+
+    template<G2_element T>
+    constexpr void serialize_to(std::span<char, serialized_size<G2u>> bytes, encoded_as<constant_t<G2u>, T> t)
+    {
+        std::forward<T>(t.value).G2_point().serialize(bytes);
+    }
 }
 
 namespace crypto12381::detail::sets 
@@ -279,6 +462,23 @@ namespace crypto12381::detail::sets
     {
         return detail::G2Point{ bytes };
     }
+
+    constexpr auto parse(constant_t<G2u>, serialized_view<G2u> bytes)
+    {
+        return detail::G2Point{ bytes };
+    }
+
+    template<typename Hash>
+    inline auto hash_to(basic_hash_state<Hash>&& state, G2_t) noexcept
+    {
+        return G2Point::from_hash(std::move(state));
+    }
+
+    template<std::ranges::range R> requires hash_state_of<std::ranges::range_value_t<R>>
+    inline auto hash_to_each(R&& states, G2_t)
+    {
+        return G2Point::from_hashes(std::forward<R>(states));
+    }
 }
 
 #endif
@@ -0,0 +1,100 @@
+#ifndef CRYPTO12381_HASH_FUNCTION_HPP
+#define CRYPTO12381_HASH_FUNCTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "miracl_core_interface.hpp"
+
+namespace crypto12381::detail
+{
+    struct sha256_state
+    {
+        std::uint32_t h[8];
+        std::uint64_t length;
+        unsigned char block[64];
+    };
+
+    void sha256_init(sha256_state& state) noexcept;
+
+    void sha256_process(sha256_state& state, std::span<const char> bytes) noexcept;
+
+    // write the 32 bytes digest
+    void sha256_hash(sha256_state& state, char* digest) noexcept;
+
+    // return true if the compression runs on the x86 SHA extensions
+    bool sha256_accelerated() noexcept;
+
+    // expand_message_xmd of RFC 9380 with SHA-256 into output, at most 255 * 32 bytes, for a state which has
+    // absorbed the 64 zero bytes of Z_pad followed by the message, and a domain of at most 255 bytes
+    void sha256_expand_message_xmd(sha256_state& state, std::span<const char> domain, std::span<char> output) noexcept;
+
+    // zero the size bytes at p with stores the compiler does not remove, e.g. for a state which held secrets
+    void secure_zero(void* p, size_t size) noexcept;
+}
+
+namespace crypto12381::hash_functions
+{
+    // A hash function used by hash_state provides:
+    //     state_type, digest_size,
+    //     init(state), process(state, bytes), finish(state, digest)
+    // digest_size must be at least 48 bytes, so that a digest can be reduced to Zp and Fp without bias.
+
+    struct sha3_512
+    {
+        using state_type = detail::miracl_core::sha3_state;
+
+        static constexpr int digest_size = 64;
+
+        static void init(state_type& state) noexcept
+        {
+            detail::miracl_core::sha3_init(state, digest_size);
+        }
+
+        static void process(state_type& state, std::span<const char> bytes) noexcept
+        {
+            for(const auto& byte : bytes)
+            {
+                detail::miracl_core::sha3_process(state, byte);
+            }
+        }
+
+        static void finish(state_type& state, std::span<char, digest_size> digest) noexcept
+        {
+            detail::miracl_core::sha3_hash(state, digest.data());
+        }
+    };
+
+    // SHA-256 with the x86 SHA extensions when the cpu supports them.
+    // The 64 bytes digest is expand_message_xmd of RFC 9380 with the domain below, so it differs from the
+    // earlier SHA-256(transcript || 0x00) || SHA-256(transcript || 0x01) of this library.
+    struct sha256
+    {
+        using state_type = detail::sha256_state;
+
+        static constexpr int digest_size = 64;
+
+        static constexpr char domain[] = "CRYPTO12381-V01-XMD:SHA-256";
+
+        static void init(state_type& state) noexcept
+        {
+            // Z_pad of expand_message_xmd
+            constexpr char z_pad[64] = {};
+            detail::sha256_init(state);
+            detail::sha256_process(state, std::span{ z_pad });
+        }
+
+        static void process(state_type& state, std::span<const char> bytes) noexcept
+        {
+            detail::sha256_process(state, bytes);
+        }
+
+        static void finish(state_type& state, std::span<char, digest_size> digest) noexcept
+        {
+            detail::sha256_expand_message_xmd(state, std::span{ domain, sizeof(domain) - 1 }, digest);
+        }
+    };
+}
+
+#endif
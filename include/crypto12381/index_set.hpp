@@ -0,0 +1,245 @@
+#ifndef CRYPTO12381_INDEX_SET_HPP
+#define CRYPTO12381_INDEX_SET_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+namespace crypto12381
+{
+    // a set of indexes in [0, bound) as a bitset, e.g. the revealed attributes of a credential
+    // membership is O(1), the set operations work on whole words and the iteration is in increasing order
+    class index_set
+    {
+    public:
+        class iterator
+        {
+        public:
+            using value_type = size_t;
+            using difference_type = std::ptrdiff_t;
+
+            constexpr iterator() noexcept = default;
+
+            constexpr size_t operator*() const noexcept
+            {
+                return index_;
+            }
+
+            constexpr iterator& operator++() noexcept
+            {
+                index_ = set_->next(index_ + 1);
+                return *this;
+            }
+
+            constexpr iterator operator++(int) noexcept
+            {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            friend constexpr bool operator==(const iterator&, const iterator&) = default;
+
+        private:
+            friend index_set;
+
+            constexpr iterator(const index_set* set, size_t index) noexcept
+            : set_{ set }, index_{ index }
+            {}
+
+            const index_set* set_ = nullptr;
+            size_t index_ = 0;
+        };
+
+        constexpr index_set() noexcept = default;
+
+        // the empty set of indexes in [0, bound)
+        constexpr explicit index_set(size_t bound)
+        : bound_{ bound }, words_((bound + word_bits - 1) / word_bits)
+        {}
+
+        // throws std::runtime_error for an index not less than bound
+        template<std::ranges::input_range R> requires std::convertible_to<std::ranges::range_reference_t<R>, size_t>
+        constexpr index_set(size_t bound, R&& indexes)
+        : index_set{ bound }
+        {
+            for(size_t index : indexes)
+            {
+                insert(index);
+            }
+        }
+
+        constexpr index_set(size_t bound, std::initializer_list<size_t> indexes)
+        : index_set{ bound }
+        {
+            for(size_t index : indexes)
+            {
+                insert(index);
+            }
+        }
+
+        constexpr size_t bound() const noexcept
+        {
+            return bound_;
+        }
+
+        constexpr bool contains(size_t index) const noexcept
+        {
+            return index < bound_ && (words_[index / word_bits] >> (index % word_bits) & 1u) != 0;
+        }
+
+        constexpr void insert(size_t index)
+        {
+            if(index >= bound_)
+            {
+                throw std::runtime_error{ "The index is out of the bound of the index set." };
+            }
+            std::uint64_t& word = words_[index / word_bits];
+            const std::uint64_t bit = std::uint64_t{ 1 } << (index % word_bits);
+            size_ += (word & bit) == 0;
+            word |= bit;
+        }
+
+        constexpr void erase(size_t index) noexcept
+        {
+            if(contains(index))
+            {
+                words_[index / word_bits] &= ~(std::uint64_t{ 1 } << (index % word_bits));
+                --size_;
+            }
+        }
+
+        constexpr size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+
+        constexpr iterator begin() const noexcept
+        {
+            return iterator{ this, next(0) };
+        }
+
+        constexpr iterator end() const noexcept
+        {
+            return iterator{ this, bound_ };
+        }
+
+        // the indexes of this set which are not in other
+        constexpr index_set except(const index_set& other) const
+        {
+            index_set result = *this;
+            for(size_t w = 0; w < std::min(result.words_.size(), other.words_.size()); ++w)
+            {
+                result.words_[w] &= ~other.words_[w];
+            }
+            result.recount();
+            return result;
+        }
+
+        // the indexes in [0, bound) which are not in the set
+        friend constexpr index_set operator~(const index_set& set)
+        {
+            index_set result = set;
+            for(auto& word : result.words_)
+            {
+                word = ~word;
+            }
+            result.clear_tail();
+            result.size_ = set.bound_ - set.size_;
+            return result;
+        }
+
+        // the bound of the result is the least of the bounds
+        friend constexpr index_set operator&(const index_set& l, const index_set& r)
+        {
+            const index_set& shorter = l.bound_ <= r.bound_ ? l : r;
+            const index_set& longer = l.bound_ <= r.bound_ ? r : l;
+            index_set result = shorter;
+            for(size_t w = 0; w < result.words_.size(); ++w)
+            {
+                result.words_[w] &= longer.words_[w];
+            }
+            result.recount();
+            return result;
+        }
+
+        // the bound of the result is the greatest of the bounds
+        friend constexpr index_set operator|(const index_set& l, const index_set& r)
+        {
+            const index_set& shorter = l.bound_ <= r.bound_ ? l : r;
+            const index_set& longer = l.bound_ <= r.bound_ ? r : l;
+            index_set result = longer;
+            for(size_t w = 0; w < shorter.words_.size(); ++w)
+            {
+                result.words_[w] |= shorter.words_[w];
+            }
+            result.recount();
+            return result;
+        }
+
+        friend constexpr index_set operator-(const index_set& l, const index_set& r)
+        {
+            return l.except(r);
+        }
+
+        friend constexpr bool operator==(const index_set&, const index_set&) = default;
+
+    private:
+        static constexpr size_t word_bits = 64uz;
+
+        // the least index of the set which is not less than index, bound() if there is none
+        constexpr size_t next(size_t index) const noexcept
+        {
+            size_t w = index / word_bits;
+            if(w >= words_.size())
+            {
+                return bound_;
+            }
+            std::uint64_t word = words_[w] & (~std::uint64_t{ 0 } << (index % word_bits));
+            while(word == 0)
+            {
+                if(++w == words_.size())
+                {
+                    return bound_;
+                }
+                word = words_[w];
+            }
+            return w * word_bits + std::countr_zero(word);
+        }
+
+        // the bits of the last word from bound on stay zero
+        constexpr void clear_tail() noexcept
+        {
+            if(bound_ % word_bits != 0)
+            {
+                words_.back() &= ~(~std::uint64_t{ 0 } << (bound_ % word_bits));
+            }
+        }
+
+        constexpr void recount() noexcept
+        {
+            size_ = 0;
+            for(auto word : words_)
+            {
+                size_ += std::popcount(word);
+            }
+        }
+
+        size_t bound_ = 0;
+        size_t size_ = 0;
+        std::vector<std::uint64_t> words_;
+    };
+}
+
+#endif
@@ -30,6 +30,30 @@ namespace crypto12381
                 return 2uz * 48uz + 1uz;
             }
         };
+        // uncompressed encodings, parsing them needs no square root
+        struct G1u_t
+        {
+            consteval size_t serialized_size() const noexcept
+            {
+                return 2uz * 48uz + 1uz;
+            }
+        };
+        struct G2u_t
+        {
+            consteval size_t serialized_size() const noexcept
+            {
+                return 4uz * 48uz + 1uz;
+            }
+        };
+        // the numbers in Zp less than 2^Bits
+        template<size_t Bits>
+        struct Zp_bits_t
+        {
+            consteval size_t serialized_size() const noexcept
+            {
+                return 48uz;
+            }
+        };
         struct GT_t
         {
             consteval size_t serialized_size() const noexcept
@@ -42,8 +66,13 @@ namespace crypto12381
     inline constexpr detail::sets::Zp_t Zp{};
     inline constexpr detail::sets::G1_t G1{};
     inline constexpr detail::sets::G2_t G2{};
+    inline constexpr detail::sets::G1u_t G1u{};
+    inline constexpr detail::sets::G2u_t G2u{};
     inline constexpr detail::sets::GT_t GT{};
 
+    template<size_t Bits>
+    inline constexpr detail::sets::Zp_bits_t<Bits> Zp_bits{};
+
     template<auto Set>
     inline constexpr size_t serialized_size = Set.serialized_size();
 
@@ -92,6 +92,12 @@ namespace crypto12381::detail
             miracl_core::to_bytes(buffer_view, auto{ data_ });
         }
 
+        // whether the element is in the subgroup of order r, parse does not check it
+        bool is_in_subgroup() const noexcept
+        {
+            return miracl_core::is_in_subgroup(auto{ data_ });
+        }
+
         template<typename Self>
         constexpr decltype(auto) GT_point(this Self&& self) noexcept
         {
@@ -162,13 +168,13 @@ namespace crypto12381::detail
             if constexpr(gt_reusable<P>)
             {
                 decltype(auto) result = std::forward<P>(point).GT_point();
-                miracl_core::pow(result.data_, result.data_, data(std::forward<V>(number).Zp_number()));
+                pow_by(result.data_, std::forward<V>(number));
                 return result;
             }
             else
             {
                 GTPoint result = std::forward<P>(point).GT_point();
-                miracl_core::pow(result.data_, result.data_, data(std::forward<V>(number).Zp_number()));
+                pow_by(result.data_, std::forward<V>(number));
                 return result;
             }
         }
@@ -179,6 +185,24 @@ namespace crypto12381::detail
         GTPoint& operator=(const GTPoint&) = default;
         GTPoint& operator=(GTPoint&&) = default;
 
+        // the public numbers take the variable time algorithm, the bounded numbers the shorter windows
+        template<typename N>
+        static void pow_by(miracl_core::fp12& value, N&& number) noexcept
+        {
+            if constexpr(public_Zp_element<N>)
+            {
+                miracl_core::pow_vartime(value, value, data(std::forward<N>(number).Zp_number()));
+            }
+            else if constexpr(bounded_Zp_element<N>)
+            {
+                miracl_core::pow_bounded(value, value, data(std::forward<N>(number).Zp_number()), std::remove_cvref_t<N>::n_bits);
+            }
+            else
+            {
+                miracl_core::pow(value, value, data(std::forward<N>(number).Zp_number()));
+            }
+        }
+
         GTPointData data_;
     };
 
@@ -208,6 +232,21 @@ namespace crypto12381::detail
             return result;
         }
 
+        // the Miller loops of Π are multiplied first, so the product takes a single final exponentiation
+        template<std::ranges::range R> 
+        requires specified<std::ranges::range_value_t<R>, GTMiller>
+        friend constexpr GTMiller product(std::type_identity<GTMiller>, R&& r) noexcept
+        {
+            auto iter = std::ranges::begin(r);
+            GTMiller result{ *iter };
+            for(auto i = ++iter; i != std::ranges::end(r); ++i)
+            {
+                GTMiller other{ *i };
+                miracl_core::multiply(result.data_, other.data_);
+            }
+            return result;
+        }
+
         template<specified<GTMiller> Self>
         friend constexpr GTMiller inverse(Self&& self) noexcept
         {
@@ -249,8 +288,8 @@ namespace crypto12381::detail
         {
             miracl_core::pair_ate(
                 data_,
-                data(std::forward<Pair>(pair).p2().G2_point()),
-                data(std::forward<Pair>(pair).p1().G1_point())
+                data(std::forward<Pair>(pair).p2().G2_point()).ecp,
+                data(std::forward<Pair>(pair).p1().G1_point()).ecp
             );
         }
 
@@ -283,6 +322,28 @@ namespace crypto12381::detail
             return GTMiller{ std::forward<Self>(self) }.GT_point();
         }
 
+        // the Miller loop once for all the elements of Σ or Π, the final exponentiation stays with the result
+        template<specified<GTPair> Self>
+        friend GTMiller hoist(Self&& self) noexcept
+        {
+            return GTMiller{ std::forward<Self>(self) };
+        }
+
+        // Π(pair(P[i], Q[i])) with a Miller loop per pair and a single final exponentiation
+        template<std::ranges::range R> 
+        requires specified<std::ranges::range_value_t<R>, GTPair>
+        friend constexpr GTMiller product(std::type_identity<GTPair>, R&& r) noexcept
+        {
+            auto iter = std::ranges::begin(r);
+            GTMiller result{ *iter };
+            for(auto i = ++iter; i != std::ranges::end(r); ++i)
+            {
+                GTMiller other{ *i };
+                miracl_core::multiply(result.data_, other.data_);
+            }
+            return result;
+        }
+
         // void show() const
         // {
         //     BLS12381::FP12_output(data(GT_point()));
@@ -294,10 +355,10 @@ namespace crypto12381::detail
             auto result = data.create<GTMiller>();
             miracl_core::pair_double_ate(
                 data(result),
-                data(std::forward<L>(l).p2().G2_point()), 
-                data(std::forward<L>(l).p1().G1_point()), 
-                data(std::forward<R>(r).p2().G2_point()), 
-                data(std::forward<R>(r).p1().G1_point())
+                data(std::forward<L>(l).p2().G2_point()).ecp, 
+                data(std::forward<L>(l).p1().G1_point()).ecp, 
+                data(std::forward<R>(r).p2().G2_point()).ecp, 
+                data(std::forward<R>(r).p1().G1_point()).ecp
             );
             return result;
         }
@@ -333,6 +394,22 @@ namespace crypto12381::detail
         return GTPair<P1, P2>{ std::forward<P1>(p1), std::forward<P2>(p2) };
     }
 
+    struct pair_fn
+    {
+        template<G1_element P1, G2_element P2>
+        static constexpr GTPair<P1, P2> operator()(P1&& p1, P2&& p2) noexcept
+        {
+            return pair(std::forward<P1>(p1), std::forward<P2>(p2));
+        }
+    };
+
+    // a pairing of symbolic points, e.g. pair(P[i], Q) in Π[n](pair(P[i], Q) * pair(A, B))
+    template<class P1, class P2> requires (symbolic<P1> || symbolic<P2>)
+    constexpr auto pair(P1&& p1, P2&& p2)
+    {
+        return symbolic_invoke(pair_fn{}, std::forward<P1>(p1), std::forward<P2>(p2));
+    }
+
     template<GT_element L, GT_element R>
     constexpr bool operator==(L&& l, R&& r) noexcept
     {
@@ -3,6 +3,8 @@
 
 #include "random.hpp"
 #include <cstdint>
+#include <memory_resource>
+#include <vector>
 
 namespace crypto12381::detail::miracl_core
 {
@@ -45,10 +47,19 @@ namespace crypto12381::detail::miracl_core
     //return 1 if l > r, return -1 if l < r, return 0 if l == r
     int compare(const big& l, const big& r) noexcept;
 
+    // the number of bits of the normalized value
+    int bit_count(const big& value) noexcept;
+
+    // result = 2^n
+    void power_of_two(big& result, int n) noexcept;
+
     void to_bytes(char* result, const big& value) noexcept;
 
     void random_in(big& result, const big& modulus, RandomEngine& random) noexcept;
 
+    // results[i] = a random number in [0, modulus) for i in [n], drawn with a single request to random
+    void random_in(big* results, size_t n, const big& modulus, RandomEngine& random) noexcept;
+
     void multiply(big2& result, const big& l, const big& r) noexcept;
 
     chunk_t split(big& high_part, big& low_part, const big2& value, int position) noexcept;
@@ -86,26 +97,53 @@ namespace crypto12381::detail::miracl_core
         fp z;
     };
 
+    constexpr bool same_representation(const fp& l, const fp& r) noexcept
+    {
+        for(size_t i = 0; i < n_chunks; ++i)
+        {
+            if(l.g[i] != r.g[i])
+            {
+                return false;
+            }
+        }
+        return l.xes == r.xes;
+    }
+
     //return 1 if successed else return 0
     int from_bytes(point1& result, bytes_view& bytes) noexcept;
 
+    // from the 49 bytes 0x02 or 0x03 || x, with a fixed addition chain for the square root
+    //return 1 if successed else return 0
+    int decompress(point1& result, const char* bytes) noexcept;
+
+    // return true if point is in the subgroup of order r, with the endomorphism test instead of r * point
+    bool is_in_subgroup(point1& point) noexcept;
+
     void to_bytes(bytes_view& result, point1& point, bool compressed) noexcept;
 
+    // the 48 bytes of x as to_bytes writes them, for an affine point, which skips the affine conversion
+    void affine_x_to_bytes(char* result, const point1& point) noexcept;
+
     bool is_infinity(const point1& point) noexcept;
 
     void negate(point1& point) noexcept;
 
     // object = object + point
-    void add(point1& object, point1& point) noexcept;
+    void add(point1& object, const point1& point) noexcept;
 
-    //result = Σ(numbers[i] * points[i]) for i in [n]
-    void sum_of_products(point1& result, int n, point1* points, const big* numbers) noexcept;
+    // result = Σ(points[i]) for i in [n] by a balanced tree, whose long levels add in affine coordinates
+    // with one inversion for each level, in variable time
+    void sum(point1& result, size_t n, const point1* points);
+
+    //result = Σ(numbers[i] * points[i]) for i in [n] in constant time for numbers[i] < 2^n_bits,
+    // with fixed windows and the buckets of all windows for many points, the time depends on n and n_bits only
+    void sum_of_products(point1& result, size_t n, const point1* points, const big* numbers, int n_bits);
 
     // object = object - point
-    void sub(point1& object, point1& point) noexcept;
+    void sub(point1& object, const point1& point) noexcept;
 
     // return 1 if l == r else return 0
-    int equal(point1& l, point1& r) noexcept;
+    int equal(const point1& l, const point1& r) noexcept;
 
     void residue(fp& result, const big& value) noexcept;
 
@@ -113,6 +151,10 @@ namespace crypto12381::detail::miracl_core
 
     void multiply_cofactor(point1& object) noexcept;
 
+    // results[i] = multiply_cofactor(map_to_point(values[i])) for i in [n]
+    // the constants of the map are loaded once and the square test takes the fixed chain
+    void map_to_points(point1* results, size_t n, const fp* values) noexcept;
+
     void get_infinity(point1& result) noexcept;
 
     //return 1 if successed else return 0
@@ -121,8 +163,65 @@ namespace crypto12381::detail::miracl_core
     // object = value * object
     void multiply(point1& object, const big& value) noexcept;
 
+    // objects[i] = value * objects[i] for i in [n] in constant time, with the glv split and windows of value recoded once
+    void multiply(point1* objects, size_t n, const big& value) noexcept;
+
     // p1 = v1 * p1 + v2 * p2
     void double_multiply(point1& p1, point1& p2, big& v1, big& v2) noexcept;
+
+    // the bounded versions below run in constant time for value < 2^n_bits and n_bits <= 128, their time depends on n_bits only
+
+    // object = value * object
+    void multiply_bounded(point1& object, const big& value, int n_bits) noexcept;
+
+    // objects[i] = value * objects[i] for i in [n], with the windows of value recoded once
+    void multiply_bounded(point1* objects, size_t n, const big& value, int n_bits) noexcept;
+
+    // p1 = v1 * p1 + v2 * p2
+    void double_multiply_bounded(point1& p1, point1& p2, const big& v1, const big& v2, int n_bits) noexcept;
+
+    // the variable time versions below are for public numbers only
+
+    // object = value * object with the glv endomorphism and interleaved nafs
+    void multiply_vartime(point1& object, const big& value) noexcept;
+
+    // p1 = v1 * p1 + v2 * p2
+    void double_multiply_vartime(point1& p1, point1& p2, const big& v1, const big& v2) noexcept;
+
+    //result = Σ(numbers[i] * points[i]) for i in [n], with signed buckets for many points
+    void sum_of_products_vartime(point1& result, size_t n, const point1* points, const big* numbers);
+
+    // Σ(numbers[i] * points[i]) for numbers[i] < 2^n_bits accumulated chunk by chunk,
+    // only a bucket of each odd digit of each fixed window is kept between the chunks
+    class product_buckets
+    {
+    public:
+        // with the window of the least cost for about n numbers, the buckets are allocated from resource
+        product_buckets(size_t n, int n_bits, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        // in constant time, every addition reads and writes all the buckets of its window
+        void add(size_t n, const point1* points, const big* numbers) noexcept;
+
+        // adds to the buckets indexed by the digits, for public numbers only
+        void add_vartime(size_t n, const point1* points, const big* numbers) noexcept;
+
+        // result = the sum of all added products, the buckets are kept for more chunks
+        void finish(point1& result) const noexcept;
+
+        int bit_count() const noexcept
+        {
+            return n_bits_;
+        }
+
+    private:
+        int n_bits_;
+        int window_;
+        int n_windows_;
+        int n_buckets_;
+        std::pmr::vector<point1> buckets_;
+        point1 top_;
+        point1 correction_;
+    };
 }
 
 namespace crypto12381::detail::miracl_core
@@ -140,31 +239,65 @@ namespace crypto12381::detail::miracl_core
         fp2 z;
     };
 
+    constexpr bool same_representation(const fp2& l, const fp2& r) noexcept
+    {
+        return same_representation(l.a, r.a) && same_representation(l.b, r.b);
+    }
+
     //return 1 if successed else return 0
     int from_bytes(point2& result, bytes_view& bytes) noexcept;
 
+    // from the 97 bytes 0x02 or 0x03 || x, with the complex method for the square root in Fp2
+    //return 1 if successed else return 0
+    int decompress(point2& result, const char* bytes) noexcept;
+
+    // return true if point is in the subgroup of order r, with the endomorphism test instead of r * point
+    bool is_in_subgroup(point2& point) noexcept;
+
     void to_bytes(bytes_view& result, point2& point, bool compressed) noexcept;
 
+    // the 96 bytes of x as to_bytes writes them, for an affine point
+    void affine_x_to_bytes(char* result, const point2& point) noexcept;
+
     bool is_infinity(const point2& point) noexcept;
 
     // object = value * object
     void multiply(point2& object, const big& value) noexcept;
 
+    // objects[i] = value * objects[i] for i in [n] in constant time, with the split and digits of value recoded once
+    void multiply(point2* objects, size_t n, const big& value) noexcept;
+
+    // object = value * object in constant time for value < 2^n_bits and n_bits <= 128, the time depends on n_bits only
+    void multiply_bounded(point2& object, const big& value, int n_bits) noexcept;
+
+    // objects[i] = value * objects[i] for i in [n], with the split and windows of value recoded once
+    void multiply_bounded(point2* objects, size_t n, const big& value, int n_bits) noexcept;
+
+    // object = value * object with the psi endomorphism and interleaved nafs, for public values only
+    void multiply_vartime(point2& object, const big& value) noexcept;
+
     void negate(point2& point) noexcept;
 
     // object = object + point
-    void add(point2& object, point2& point) noexcept;
+    void add(point2& object, const point2& point) noexcept;
+
+    // result = Σ(points[i]) for i in [n] as the sum of point1 above
+    void sum(point2& result, size_t n, const point2* points);
 
     // object = object - point
-    void sub(point2& object, point2& point) noexcept;
+    void sub(point2& object, const point2& point) noexcept;
 
     // return 1 if l == r else return 0
-    int equal(point2& l, point2& r) noexcept;
+    int equal(const point2& l, const point2& r) noexcept;
 
     void get_infinity(point2& result) noexcept;
 
     //return 1 if successed else return 0
     int get_default_generator(point2& result) noexcept;
+
+    // results[i] = the point of values[i] by ECP2_map2point with the cofactor cleared as ECP2_cfp, for i in [n]
+    // the cofactor is cleared by the frobenius and the chain of the public |x|, the frobenius constant is inverted once
+    void map_to_points(point2* results, size_t n, const fp2* values) noexcept;
 }
 
 namespace crypto12381::detail::miracl_core
@@ -191,17 +324,27 @@ namespace crypto12381::detail::miracl_core
 
     void multiply(fp12& result, fp12& value) noexcept;
 
+    // result = base^exponent in constant time
     void pow(fp12& result, fp12& base, const big& exponent) noexcept;
 
+    // result = base^exponent in constant time for exponent < 2^n_bits and n_bits <= 128, the time depends on n_bits only
+    void pow_bounded(fp12& result, fp12& base, const big& exponent, int n_bits) noexcept;
+
+    // result = base^exponent with the frobenius endomorphism and interleaved nafs, for public exponents only
+    void pow_vartime(fp12& result, fp12& base, const big& exponent) noexcept;
+
     int equal(fp12& l, fp12& r) noexcept;
 
     bool is_unity(fp12& value) noexcept;
 
-    void pair_ate(fp12& result, point2& p2, point1& p1) noexcept;
+    // return true if value is in the subgroup of order r, with the frobenius test instead of value^r
+    bool is_in_subgroup(fp12& value) noexcept;
+
+    void pair_ate(fp12& result, const point2& p2, const point1& p1) noexcept;
 
     void pair_final_exponentiation(fp12& object) noexcept;
 
-    void pair_double_ate(fp12& result, point2& p2, point1& p1, point2& q2, point1& q1) noexcept;
+    void pair_double_ate(fp12& result, const point2& p2, const point1& p1, const point2& q2, const point1& q1) noexcept;
 }
 
 #endif
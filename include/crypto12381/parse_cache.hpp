@@ -0,0 +1,136 @@
+#ifndef CRYPTO12381_PARSE_CACHE_HPP
+#define CRYPTO12381_PARSE_CACHE_HPP
+
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+
+#include "set.hpp"
+#include "g1_point.hpp"
+#include "g2_point.hpp"
+
+namespace crypto12381::detail
+{
+    // the least recently used parsed elements of Set keyed by their bytes
+    template<auto Set>
+    class parse_cache_part
+    {
+    public:
+        using element_t = std::remove_cvref_t<decltype(crypto12381::parse<Set>(std::declval<serialized_view<Set>>()))>;
+
+        element_t parse(serialized_view<Set> bytes, size_t capacity)
+        {
+            const std::string_view key{ bytes.data(), bytes.size() };
+            {
+                std::lock_guard lock{ mutex_ };
+                if(auto iter = index_.find(key); iter != index_.end())
+                {
+                    entries_.splice(entries_.begin(), entries_, iter->second);
+                    return iter->second->element;
+                }
+            }
+
+            // decompress without holding the lock, concurrent misses on the same bytes both parse
+            element_t element = crypto12381::parse<Set>(bytes);
+            if(capacity == 0)
+            {
+                return element;
+            }
+
+            std::lock_guard lock{ mutex_ };
+            if(index_.contains(key))
+            {
+                return element;
+            }
+
+            serialized_field<Set> field;
+            std::memcpy(field.data(), bytes.data(), field.size());
+            entries_.push_front(entry{ field, element });
+            index_.emplace(std::string_view{ entries_.front().bytes.data(), field.size() }, entries_.begin());
+            while(entries_.size() > capacity)
+            {
+                index_.erase(std::string_view{ entries_.back().bytes.data(), field.size() });
+                entries_.pop_back();
+            }
+            return element;
+        }
+
+        size_t size()
+        {
+            std::lock_guard lock{ mutex_ };
+            return entries_.size();
+        }
+
+        void clear()
+        {
+            std::lock_guard lock{ mutex_ };
+            index_.clear();
+            entries_.clear();
+        }
+
+    private:
+        struct entry
+        {
+            serialized_field<Set> bytes;
+            element_t element;
+        };
+
+        std::mutex mutex_;
+        std::list<entry> entries_;
+        // the keys view the bytes of the entries
+        std::unordered_map<std::string_view, typename std::list<entry>::iterator> index_;
+    };
+}
+
+namespace crypto12381
+{
+    // an opt-in cache of parsed elements of the sets Set..., safe to share between threads
+    // parse<S>(bytes, cache) decompresses the same bytes only once while they stay
+    // among the capacity most recently parsed elements of S
+    template<auto...Set>
+    class basic_parse_cache
+    {
+    public:
+        explicit basic_parse_cache(size_t capacity) noexcept
+        : capacity_{ capacity }
+        {}
+
+        basic_parse_cache(const basic_parse_cache&) = delete;
+        basic_parse_cache& operator=(const basic_parse_cache&) = delete;
+
+        template<auto S> requires (... || std::same_as<decltype(S), decltype(Set)>)
+        auto parse(serialized_view<S> bytes)
+        {
+            return std::get<detail::parse_cache_part<S>>(parts_).parse(bytes, capacity_);
+        }
+
+        size_t capacity() const noexcept
+        {
+            return capacity_;
+        }
+
+        // the number of cached elements of S
+        template<auto S> requires (... || std::same_as<decltype(S), decltype(Set)>)
+        size_t size()
+        {
+            return std::get<detail::parse_cache_part<S>>(parts_).size();
+        }
+
+        void clear()
+        {
+            std::apply([](auto&...part){ (..., part.clear()); }, parts_);
+        }
+
+    private:
+        size_t capacity_;
+        std::tuple<detail::parse_cache_part<Set>...> parts_;
+    };
+
+    // caches the points whose parsing needs a square root
+    using ParseCache = basic_parse_cache<G1, G2>;
+}
+
+#endif
@@ -2,9 +2,18 @@
 #define CRYPTO12381_RANDOM_HPP
 
 #include <span>
+#include <vector>
 
-namespace crypto12381 
+namespace crypto12381
 {
+    enum class random_backend
+    {
+        // MIRACL's SHA-256 based csprng, generating one byte at a time
+        csprng,
+        // AES-256 in counter mode on AES-NI when available, rekeyed after each request
+        aes_ctr
+    };
+
     struct RandomEngine
     {
     public:
@@ -13,21 +22,34 @@ namespace crypto12381
             return impl_;
         }
 
-        explicit RandomEngine(std::span<const char> seed);
+        explicit RandomEngine(std::span<const char> seed, random_backend backend = random_backend::csprng);
 
         RandomEngine(const RandomEngine&) = delete;
         RandomEngine& operator=(const RandomEngine&) = delete;
 
+        // other can only be destroyed afterwards, the other members require an engine which was not moved from
+        RandomEngine(RandomEngine&& other) noexcept;
+
         ~RandomEngine() noexcept;
+
+        random_backend backend() const noexcept;
+
+        void fill(std::span<char> bytes) noexcept;
+
+        // k independent engines seeded from this one, the same state always gives the same children
+        std::vector<RandomEngine> fork(size_t k);
+
+        // same as fork(1).front()
+        RandomEngine split();
     private:
         struct Impl;
-        
+
         Impl* impl_;
     };
 
-    constexpr RandomEngine create_random_engine(std::span<const char> seed)
+    constexpr RandomEngine create_random_engine(std::span<const char> seed, random_backend backend = random_backend::csprng)
     {
-        return RandomEngine{ seed };
+        return RandomEngine{ seed, backend };
     }
 }
 
@@ -1,16 +1,24 @@
 #ifndef CRYPTO12381_SET_HPP
 #define CRYPTO12381_SET_HPP
 
+#include <algorithm>
+#include <array>
 #include <print>
 
+#include <optional>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
 #include <ranges>
+#include <span>
+#include <vector>
 
 #include "miracl_core_interface.hpp"
+#include "hash_function.hpp"
 
 #include "general.hpp"
 #include "random.hpp"
+#include "execution.hpp"
 #include "constant.hpp"
 #include "interface.hpp"
 #include "algebra.hpp"
@@ -44,6 +52,9 @@ namespace crypto12381
         template<auto...Set>
         struct parse_fn;
 
+        template<auto...Set>
+        struct parse_checked_fn;
+
         template<auto Set>
         struct encode_to_fn;
     }
@@ -54,6 +65,9 @@ namespace crypto12381
     template<auto...Set>
     inline constexpr detail::parse_fn<Set...> parse{};
 
+    template<auto...Set>
+    inline constexpr detail::parse_checked_fn<Set...> parse_checked{};
+
     template<auto Set>
     inline constexpr detail::encode_to_fn<Set> encode_to{};
 }
@@ -70,6 +84,8 @@ namespace crypto12381::detail
 
     void hash_to();
 
+    void hash_to_each();
+
     template<typename L, typename R>
     constexpr auto pow(L&& l, R&& r)
     noexcept(noexcept(std::forward<L>(l) ^ std::forward<R>(r)))
@@ -85,13 +101,76 @@ namespace crypto12381::detail
 
         friend constexpr auto operator-(RandomEngine& random, select_vector_in_fn self) noexcept
         {
-            return std::views::repeat(0, self.n) 
+            // sets which can draw all the elements at once
+            if constexpr(requires{ select_in(std::integral_constant<decltype(Set), Set>{}, random, self.n); })
+            {
+                return select_in(std::integral_constant<decltype(Set), Set>{}, random, self.n);
+            }
+            else return std::views::repeat(0, self.n) 
                 | transform([&](auto){
                     return select_in(std::integral_constant<decltype(Set), Set>{}, random);
                 });
         }
     };
 
+    template<auto Set>
+    struct select_vector_in_parallel_fn
+    {
+        size_t n;
+        parallel_policy policy;
+
+        friend auto operator-(RandomEngine& random, select_vector_in_parallel_fn self)
+        requires requires{ select_in(std::integral_constant<decltype(Set), Set>{}, random, self.n); }
+        {
+            // each fixed chunk is drawn by its own fork, so the result does not depend on the count of threads
+            constexpr size_t chunk_size = 1024uz;
+            const size_t n_chunks = (self.n + chunk_size - 1) / chunk_size;
+            auto children = random.fork(n_chunks);
+
+            using part_t = decltype(select_in(std::integral_constant<decltype(Set), Set>{}, random, self.n));
+            scratch_vector<std::optional<part_t>> parts(scratch_resource());
+            parts.resize(n_chunks);
+            parallel_for(n_chunks, [&](size_t i)
+            {
+                parts[i].emplace(select_in(
+                    std::integral_constant<decltype(Set), Set>{}, 
+                    children[i], 
+                    std::min(chunk_size, self.n - i * chunk_size)
+                ));
+            }, self.policy);
+
+            scratch_vector<std::ranges::range_value_t<part_t>> result(result_resource());
+            result.reserve(self.n);
+            for(auto& part : parts)
+            {
+                for(auto& e : *part)
+                {
+                    result.push_back(std::move(e));
+                }
+            }
+            return std::move(result) | algebraic;
+        }
+    };
+
+    template<auto Set, size_t N>
+    struct select_array_in_fn
+    {
+        friend constexpr auto operator-(RandomEngine& random, select_array_in_fn) noexcept
+        {
+            // sets which can draw all the elements at once
+            if constexpr(requires{ select_in(std::integral_constant<decltype(Set), Set>{}, random, constant<N>); })
+            {
+                return select_in(std::integral_constant<decltype(Set), Set>{}, random, constant<N>);
+            }
+            else return [&]<size_t...I>(std::index_sequence<I...>){
+                using element_t = decltype(select_in(std::integral_constant<decltype(Set), Set>{}, random));
+                return std::array<element_t, N>{
+                    ((void)I, select_in(std::integral_constant<decltype(Set), Set>{}, random))...
+                } | algebraic;
+            }(std::make_index_sequence<N>{});
+        }
+    };
+
     template<auto Set>
     struct select_in_fn
     {
@@ -104,6 +183,18 @@ namespace crypto12381::detail
         {
             return select_vector_in_fn<Set>{ n };
         }
+
+        constexpr auto operator()(size_t n, parallel_policy policy) const noexcept
+        {
+            return select_vector_in_parallel_fn<Set>{ n, policy };
+        }
+
+        // N elements kept in place in an array, e.g. random-select_in<Zp>(constant<4>)
+        template<typename T, T N>
+        constexpr auto operator()(std::integral_constant<T, N>) const noexcept
+        {
+            return select_array_in_fn<Set, static_cast<size_t>(N)>{};
+        }
         
         friend constexpr auto operator-(RandomEngine& random, select_in_fn) noexcept
         {
@@ -111,11 +202,27 @@ namespace crypto12381::detail
         }
     };
 
+    // the size of a range which is known at compile time, std::dynamic_extent for the others
+    template<typename T>
+    inline constexpr size_t static_size = std::dynamic_extent;
+
+    template<typename T, size_t N>
+    inline constexpr size_t static_size<std::array<T, N>> = N;
+
+    template<typename T, size_t N>
+    inline constexpr size_t static_size<T[N]> = N;
+
+    template<typename T, size_t N>
+    inline constexpr size_t static_size<std::span<T, N>> = N;
+
     template<auto...Set>
     struct parse_fn
     {
         static constexpr size_t bytes_size = (0uz + ... + serialized_size<Set>);
 
+        // the ranges of a size known at compile time below this are parsed in place
+        static constexpr size_t in_place_limit = 64uz;
+
         static constexpr auto sizes = std::array{ serialized_size<Set>... };
         static constexpr auto offsets = []()
         {
@@ -127,35 +234,41 @@ namespace crypto12381::detail
             return result;
         }();
 
-        template<typename T>
-        constexpr auto operator()(T&& t) const
+        // cache is an optional basic_parse_cache, which parses the sets it holds
+        template<typename T, typename...Cache>
+        requires (sizeof...(Cache) <= 1uz) && (not std::same_as<std::remove_cvref_t<T>, parallel_policy>)
+        constexpr auto operator()(T&& t, Cache&...cache) const
         {
             if constexpr(std::is_trivially_copyable_v<std::remove_cvref_t<T>> && sizeof(t) == bytes_size)
             {
-                return (*this)(std::span{ reinterpret_cast<const char(&)[sizeof(t)]>(t) });
+                return (*this)(std::span{ reinterpret_cast<const char(&)[sizeof(t)]>(t) }, cache...);
             }
             else if constexpr(std::convertible_to<T&, std::span<const char, bytes_size>>)
             {
                 const auto bytes = (std::span<const char, bytes_size>)t;
                 if constexpr(sizeof...(Set) == 1uz)
                 {
-                    return (..., parse(constant<Set>, bytes));
+                    return (..., parse_one<Set>(bytes, cache...));
                 }
                 else return [&]<size_t...I>(std::index_sequence<I...>){
                     using tpl = std::tuple<constant_t<Set>...>;
                     return std::tuple{
-                        parse(std::tuple_element_t<I, tpl>{}, (bytes.template subspan<offsets[I], sizes[I]>()))...
+                        parse_one<std::tuple_element_t<I, tpl>::value>(
+                            bytes.template subspan<offsets[I], sizes[I]>(), cache...
+                        )...
                     };
-
-                    // clang bug
-                    // return std::tuple{
-                    //     parse(constant_t<Set>{}, (bytes.template subspan<offsets[I], sizes[I]>()))...
-                    // };
                 }(std::make_index_sequence<sizeof...(Set)>{});
             }
+            else if constexpr(
+                static_size<std::remove_cvref_t<T>> < in_place_limit && 
+                requires(std::ranges::range_value_t<T> e){ (*this)(e); }
+            )
+            {
+                return parse_fixed(std::forward<T>(t), cache...);
+            }
             else if constexpr(std::ranges::range<T> && requires(std::ranges::range_value_t<T> e){ (*this)(e); })
             {
-                return std::forward<T>(t) | transform(crypto12381::parse<Set...>);
+                return parse_all(std::forward<T>(t), cache...);
             }
             else
             {
@@ -163,10 +276,83 @@ namespace crypto12381::detail
             }
         }
 
-        template<typename T>
-        constexpr auto operator()(std::reference_wrapper<T> t) const
+        template<typename T, typename...Cache> requires (sizeof...(Cache) <= 1uz)
+        constexpr auto operator()(std::reference_wrapper<T> t, Cache&...cache) const
         {
-            return (*this)(t.get());
+            return (*this)(t.get(), cache...);
+        }
+
+        // parse(parallel, r) parses the elements of r on the threads of parallel into a materialized range,
+        // which share the cache
+        template<std::ranges::random_access_range R, typename...Cache>
+        requires std::ranges::sized_range<R> && (sizeof...(Cache) <= 1uz)
+        auto operator()(parallel_policy policy, R&& r, Cache&...cache) const
+        {
+            using element_t = decltype(crypto12381::parse<Set...>(*std::ranges::begin(r), cache...));
+            const size_t n = std::ranges::size(r);
+            scratch_vector<std::optional<element_t>> elements(scratch_resource());
+            elements.resize(n);
+            parallel_for(n, [&](size_t i)
+            {
+                elements[i].emplace(crypto12381::parse<Set...>(std::ranges::begin(r)[i], cache...));
+            }, policy);
+
+            scratch_vector<element_t> result(result_resource());
+            result.reserve(n);
+            for(auto& e : elements)
+            {
+                result.push_back(std::move(*e));
+            }
+            return std::move(result) | algebraic;
+        }
+
+    private:
+        template<auto S, typename...Cache>
+        static constexpr auto parse_one(serialized_view<S> bytes, Cache&...cache)
+        {
+            if constexpr(sizeof...(Cache) == 1uz && (... && requires{ cache.template parse<S>(bytes); }))
+            {
+                return (..., cache.template parse<S>(bytes));
+            }
+            else if constexpr(requires{ parse(constant<S>, bytes, cache...); })
+            {
+                return parse(constant<S>, bytes, cache...);
+            }
+            else
+            {
+                return parse(constant<S>, bytes);
+            }
+        }
+
+        // parse every element once, unlike a lazy view which parses again on every access
+        template<std::ranges::range R, typename...Cache>
+        static auto parse_all(R&& r, Cache&...cache)
+        {
+            using element_t = decltype(crypto12381::parse<Set...>(*std::ranges::begin(r), cache...));
+            scratch_vector<element_t> result(result_resource());
+
+            if constexpr(std::ranges::sized_range<R>)
+            {
+                result.reserve(std::ranges::size(r));
+            }
+
+            for(auto&& e : r)
+            {
+                result.push_back(crypto12381::parse<Set...>(e, cache...));
+            }
+            return std::move(result) | algebraic;
+        }
+
+        // a short range of a size known at compile time, e.g. a std::array of fields, parsed in place
+        template<std::ranges::range R, typename...Cache>
+        static auto parse_fixed(R&& r, Cache&...cache)
+        {
+            constexpr size_t n = static_size<std::remove_cvref_t<R>>;
+            using element_t = decltype(crypto12381::parse<Set...>(*std::ranges::begin(r), cache...));
+            const auto first = std::ranges::begin(r);
+            return [&]<size_t...I>(std::index_sequence<I...>){
+                return std::array<element_t, n>{ crypto12381::parse<Set...>(first[I], cache...)... } | algebraic;
+            }(std::make_index_sequence<n>{});
         }
 
         // constexpr auto operator()(std::span<const char, bytes_size> bytes) const
@@ -202,6 +388,40 @@ namespace crypto12381::detail
         // }
     };
 
+    // passed to parse in place of a cache, rejects elements outside of the subgroup of order r
+    struct subgroup_check_t
+    {
+        template<auto S> requires requires(serialized_view<S> bytes){ crypto12381::parse<S>(bytes).is_in_subgroup(); }
+        auto parse(serialized_view<S> bytes) const
+        {
+            auto element = crypto12381::parse<S>(bytes);
+            if(!element.is_in_subgroup())
+            {
+                throw std::runtime_error{ "The parsed element is not in the subgroup." };
+            }
+            return element;
+        }
+    };
+
+    // same as parse_fn, for untrusted bytes
+    template<auto...Set>
+    struct parse_checked_fn
+    {
+        template<typename T>
+        constexpr auto operator()(T&& t) const
+        {
+            const subgroup_check_t check{};
+            return crypto12381::parse<Set...>(std::forward<T>(t), check);
+        }
+
+        template<typename R>
+        auto operator()(parallel_policy policy, R&& r) const
+        {
+            const subgroup_check_t check{};
+            return crypto12381::parse<Set...>(policy, std::forward<R>(r), check);
+        }
+    };
+
     template<auto Set>
     struct encode_to_fn
     {
@@ -211,10 +431,23 @@ namespace crypto12381::detail
         };
     };
 
+    // an element serialized as an element of Set::value, made by serialize_as
+    template<typename Set, typename T>
+    struct encoded_as
+    {
+        static constexpr auto encoded_set = Set::value;
+
+        T value;
+    };
+
     template<typename T>
     consteval auto group_of()
     {
-        if constexpr(element_of<T, Zp>)
+        if constexpr(requires{ std::remove_cvref_t<T>::encoded_set; })
+        {
+            return std::remove_cvref_t<T>::encoded_set;
+        }
+        else if constexpr(element_of<T, Zp>)
         {
             return Zp;
         }
@@ -310,30 +543,86 @@ namespace crypto12381
     }
 
     inline constexpr detail::serialize_fn serialize{};
+
+    namespace detail
+    {
+        template<auto...Set>
+        struct serialize_as_fn
+        {
+            template<not_symbolic...Args> requires (sizeof...(Args) == sizeof...(Set))
+            constexpr auto operator()(Args&&...args) const
+            {
+                // expanding Set and Args together trips clang, as in parse_fn
+                return [&]<size_t...I>(std::index_sequence<I...>){
+                    using sets = std::tuple<constant_t<Set>...>;
+                    return serialize_pack<encoded_as<std::tuple_element_t<I, sets>, Args>...>{{
+                        encoded_as<std::tuple_element_t<I, sets>, Args>{ std::forward<Args>(args) }...
+                    }};
+                }(std::index_sequence_for<Args...>{});
+            }
+        };
+
+        // the natural encoding of T, e.g. serialize_as<G1> on a G1 element
+        template<typename Set, typename T> requires std::same_as<decltype(group_of<T>()), typename Set::value_type>
+        constexpr void serialize_to(std::span<char, serialized_size<Set::value>> bytes, encoded_as<Set, T> t)
+        {
+            serialize_to(bytes, std::forward<T>(t.value));
+        }
+    }
+
+    // serialize the elements as elements of Set..., e.g. serialize_as<Zp, G1u>(x, g)
+    template<auto...Set>
+    inline constexpr detail::serialize_as_fn<Set...> serialize_as{};
 }
 
 namespace crypto12381::detail 
 {
-    class hash_state
+    template<typename Hash, typename...T>
+    struct hash_fork_pack;
+
+    template<typename Hash = hash_functions::sha3_512>
+    class basic_hash_state
     {
     public:
-        static constexpr const int hash_size = 64;
+        using hash_function = Hash;
+
+        static constexpr const int hash_size = Hash::digest_size;
+
+        basic_hash_state() noexcept
+        {
+            Hash::init(state_);
+        }
+
+        basic_hash_state(basic_hash_state&&) noexcept = default;
+
+        // the state holds data derived from the hashed secrets
+        ~basic_hash_state()
+        {
+            secure_zero(&state_, sizeof(state_));
+        }
 
-        hash_state() noexcept
+        // snapshot of the absorbed prefix, the original state stays usable
+        basic_hash_state fork() const noexcept
         {
-            miracl_core::sha3_init(state_, hash_size);
+            return basic_hash_state{ *this };
         }
         
-        template<typename T>
-        constexpr hash_state&& operator|(const T& t)&& noexcept
+        template<typename T> requires (not symbolic<T>)
+        constexpr basic_hash_state&& operator|(const T& t)&& noexcept
         {
             process(t);
             return std::move(*this);
         }
+
+        template<symbolic T>
+        constexpr auto operator|(T&& t)&&
+        {
+            return hash_fork_pack<Hash, T>{ std::move(*this), std::tuple<T>{ std::forward<T>(t) } };
+        }
         
         void to(std::span<char, hash_size> bytes)&& noexcept
         {
-            miracl_core::sha3_hash(state_, bytes.data());
+            Hash::finish(state_, bytes);
         }
 
         auto to()&& noexcept
@@ -351,13 +640,12 @@ namespace crypto12381::detail
         }
 
     private:
+        basic_hash_state(const basic_hash_state&) noexcept = default;
+
         template<size_t N>
         void process(std::span<const char, N> bytes) noexcept
         {
-            for(const auto& byte : bytes)
-            {
-                miracl_core::sha3_process(state_, byte);
-            }
+            Hash::process(state_, bytes);
         }
 
         template<typename T>
@@ -388,29 +676,154 @@ namespace crypto12381::detail
             }
         }
 
-        miracl_core::sha3_state state_;
+        typename Hash::state_type state_;
     };
 
-    template<typename...T>
+    using hash_state = basic_hash_state<>;
+
+    template<typename T>
+    inline constexpr bool is_hash_state = false;
+
+    template<typename Hash>
+    inline constexpr bool is_hash_state<basic_hash_state<Hash>> = true;
+
+    template<typename T>
+    concept hash_state_of = is_hash_state<std::remove_cvref_t<T>>;
+
+    // a state of a range of R to hash, moved from an owned range or a range of rvalues and forked from a borrowed one,
+    // so hash_each(states) leaves states usable and hash_each(std::move(states)) takes them
+    template<typename R, typename State>
+    constexpr std::remove_cvref_t<State> take_hash_state(State&& state) noexcept
+    {
+        if constexpr(
+            not std::is_lvalue_reference_v<std::ranges::range_reference_t<R>> 
+            || (not std::is_reference_v<R> && not std::is_const_v<R> && not std::ranges::view<R>)
+        )
+        {
+            return std::move(state);
+        }
+        else
+        {
+            return state.fork();
+        }
+    }
+
+    // hashes each state of a range, a set can hash the whole range at once by hash_to_each
+    template<typename R>
+    struct hash_each_pack
+    {
+        R states;
+
+        template<typename Set>
+        constexpr auto to(Set)&&
+        {
+            if constexpr(requires{ hash_to_each(std::forward<R>(states), Set{}); })
+            {
+                return hash_to_each(std::forward<R>(states), Set{}) | algebraic;
+            }
+            else
+            {
+                scratch_vector<decltype(std::declval<std::ranges::range_value_t<R>>().to(Set{}))> results(result_resource());
+                for(auto&& state : std::forward<R>(states))
+                {
+                    results.push_back(take_hash_state<R>(state).to(Set{}));
+                }
+                return std::move(results) | algebraic;
+            }
+        }
+    };
+
+    struct hash_each_fn
+    {
+        template<std::ranges::range R> requires hash_state_of<std::ranges::range_value_t<R>>
+        constexpr hash_each_pack<R> operator()(R&& states) const
+        {
+            return hash_each_pack<R>{ std::forward<R>(states) };
+        }
+    };
+
+    template<typename Hash, typename...T>
     struct hash_pack;
 
-    template<typename Set>
-    struct hash_to_fn : symbolic_functor_interface<hash_to_fn<Set>>
+    template<typename Set, typename Hash = hash_functions::sha3_512>
+    struct hash_to_fn : symbolic_functor_interface<hash_to_fn<Set, Hash>>
     {
         using symbolic_functor_interface<hash_to_fn>::operator();
 
         template<typename...Args>
         constexpr auto operator()(Args&&...args)const
         {
-            return (hash_state{} | ... | std::forward<Args>(args)).to(Set{});
+            return (basic_hash_state<Hash>{} | ... | std::forward<Args>(args)).to(Set{});
+        }
+    };
+
+    // hashes an absorbed prefix followed by args, each evaluation works on a fork of the prefix
+    template<typename Set, typename Hash = hash_functions::sha3_512>
+    struct hash_fork_to_fn : symbolic_functor_interface<hash_fork_to_fn<Set, Hash>>
+    {
+        using symbolic_functor_interface<hash_fork_to_fn>::operator();
+
+        basic_hash_state<Hash> prefix;
+
+        explicit hash_fork_to_fn(basic_hash_state<Hash>&& state) noexcept
+        : prefix{ std::move(state) }
+        {}
+
+        hash_fork_to_fn(const hash_fork_to_fn& other) noexcept
+        : prefix{ other.prefix.fork() }
+        {}
+
+        hash_fork_to_fn(hash_fork_to_fn&&) noexcept = default;
+
+        template<typename...Args>
+        constexpr auto operator()(Args&&...args)const
+        {
+            return (prefix.fork() | ... | std::forward<Args>(args)).to(Set{});
+        }
+    };
+
+    template<typename Hash, typename...T>
+    struct hash_fork_pack
+    {
+        basic_hash_state<Hash> prefix;
+        std::tuple<T...> suffix;
+
+        template<typename U>
+        constexpr auto operator|(U&& u)&&
+        {
+            return hash_fork_pack<Hash, T..., U>{ 
+                std::move(prefix), 
+                std::tuple_cat(std::move(suffix), std::tuple<U>{ std::forward<U>(u) })
+            };
+        }
+
+        template<typename Set>
+        constexpr auto to(Set)&&
+        {
+            return [&]<size_t...I>(std::index_sequence<I...>)
+            {
+                return hash_fork_to_fn<Set, Hash>{ std::move(prefix) }((T&&)std::get<I>(suffix)...);
+            }(std::index_sequence_for<T...>{});
         }
     };
 
-    template<typename...T>
+    template<typename Hash, typename...T>
     struct hash_pack
     {
         std::tuple<T...> ranges;
 
+        // count of the leading elements which are not symbolic, they are absorbed only once
+        static constexpr size_t prefix_size = []()
+        {
+            constexpr auto is_symbolic = std::array<bool, sizeof...(T)>{ symbolic<T>... };
+            size_t n = 0;
+            while(n < sizeof...(T) && not is_symbolic[n])
+            {
+                ++n;
+            }
+            return n;
+        }();
+
         constexpr explicit hash_pack(T&&...t)
         : ranges{ std::forward<T>(t)... }
         {
@@ -423,17 +836,28 @@ namespace crypto12381::detail
         template<typename Set>
         constexpr auto to(Set)&&
         {
-            return [&]<size_t...I>(std::index_sequence<I...>)
+            if constexpr(prefix_size == 0)
             {
-                return hash_to_fn<Set>{}((T&&)std::get<I>(ranges)...);
-                // return zip_transform(
-                //     hash_to_fn<Set>{},
-                //     (T&&)std::get<I>(ranges)...
-                // );
-            }(std::index_sequence_for<T...>{});
+                return [&]<size_t...I>(std::index_sequence<I...>)
+                {
+                    return hash_to_fn<Set, Hash>{}((T&&)std::get<I>(ranges)...);
+                    // return zip_transform(
+                    //     hash_to_fn<Set>{},
+                    //     (T&&)std::get<I>(ranges)...
+                    // );
+                }(std::index_sequence_for<T...>{});
+            }
+            else return [&]<size_t...I, size_t...J>(std::index_sequence<I...>, std::index_sequence<J...>)
+            {
+                using tpl = std::tuple<T...>;
+                return hash_fork_to_fn<Set, Hash>{ (basic_hash_state<Hash>{} | ... | (std::tuple_element_t<I, tpl>&&)std::get<I>(ranges)) }(
+                    (std::tuple_element_t<prefix_size + J, tpl>&&)std::get<prefix_size + J>(ranges)...
+                );
+            }(std::make_index_sequence<prefix_size>{}, std::make_index_sequence<sizeof...(T) - prefix_size>{});
         }
     };
 
+    template<typename Hash = hash_functions::sha3_512>
     struct hash_fn// : symbolic_functor_interface<hash_fn>
     {
         //using symbolic_functor_interface<hash_fn>::operator();
@@ -444,18 +868,18 @@ namespace crypto12381::detail
             //return (hash_state{} | ... | std::forward<Args>(args));
             if constexpr(not (... || symbolic<Args>))
             {
-                return (hash_state{} | ... | std::forward<Args>(args));
+                return (basic_hash_state<Hash>{} | ... | std::forward<Args>(args));
             }
             else
             {
-                return hash_pack<Args...>{std::forward<Args>(args)...};
+                return hash_pack<Hash, Args...>{std::forward<Args>(args)...};
             }
         }
 
         template<typename T>
-        constexpr hash_state operator|(const T& t) const noexcept
+        constexpr basic_hash_state<Hash> operator|(const T& t) const noexcept
         {
-            return hash_state{} | t;
+            return basic_hash_state<Hash>{} | t;
         }
     };
 
@@ -463,6 +887,70 @@ namespace crypto12381::detail
 
     
 
+    // reduce(r) over fixed chunks of r on the threads of policy, then reduce over the results of the chunks
+    // the chunks depend on the size of r only, so the result does not depend on the count of threads
+    template<typename Reduce, std::ranges::range R>
+    auto parallel_reduce(Reduce reduce, R&& r, parallel_policy policy)
+    {
+        if constexpr(std::ranges::random_access_range<R> && std::ranges::sized_range<R>)
+        {
+            constexpr size_t min_chunk_size = 32uz;
+            constexpr size_t max_chunks = 64uz;
+            const size_t n = std::ranges::size(r);
+            const size_t chunk_size = std::max(min_chunk_size, (n + max_chunks - 1) / max_chunks);
+            const size_t n_chunks = std::max(1uz, (n + chunk_size - 1) / chunk_size);
+
+            const auto first = std::ranges::begin(r);
+            using part_t = decltype(reduce(std::ranges::subrange(first, first)));
+            scratch_vector<std::optional<part_t>> parts(scratch_resource());
+            parts.resize(n_chunks);
+            parallel_for(n_chunks, [&](size_t c)
+            {
+                const size_t begin = c * chunk_size;
+                const size_t end = std::min(n, begin + chunk_size);
+                parts[c].emplace(reduce(std::ranges::subrange(first + begin, first + end)));
+            }, policy);
+
+            return reduce(parts | std::views::transform([](auto& part) -> part_t& { return *part; }));
+        }
+        else
+        {
+            return reduce(std::forward<R>(r));
+        }
+    }
+
+    // every element of r evaluated once on the threads of policy, e.g. the hashes of a lazy range
+    template<std::ranges::range R>
+    auto parallel_materialize(R&& r, parallel_policy policy)
+    {
+        using element_t = std::remove_cvref_t<std::ranges::range_reference_t<R>>;
+        scratch_vector<element_t> result(result_resource());
+        if constexpr(std::ranges::random_access_range<R> && std::ranges::sized_range<R>)
+        {
+            const size_t n = std::ranges::size(r);
+            scratch_vector<std::optional<element_t>> elements(scratch_resource());
+            elements.resize(n);
+            parallel_for(n, [&](size_t i)
+            {
+                elements[i].emplace(std::ranges::begin(r)[i]);
+            }, policy);
+
+            result.reserve(n);
+            for(auto& e : elements)
+            {
+                result.push_back(std::move(*e));
+            }
+        }
+        else
+        {
+            for(auto&& e : r)
+            {
+                result.push_back(std::forward<decltype(e)>(e));
+            }
+        }
+        return std::move(result) | algebraic;
+    }
+
     void sum();
 
     struct sum_fn : symbolic_functor_interface<sum_fn>
@@ -475,6 +963,12 @@ namespace crypto12381::detail
             return sum(std::type_identity<std::remove_cvref_t<std::ranges::range_value_t<R>>>{}, std::forward<R>(r));
         }
 
+        template<std::ranges::range R> requires (not symbolic<R>)
+        auto operator()(parallel_policy policy, R&& r) const
+        {
+            return parallel_reduce(sum_fn{}, std::forward<R>(r), policy);
+        }
+
         // template<typename F>
         // constexpr auto operator()(size_t n, F&& f) const
         // {
@@ -505,6 +999,22 @@ namespace crypto12381::detail
         {
             return (*this)[i.in[n]];
         }
+
+        // Σ[parallel, n](...) reduces over the threads of parallel
+        template<fixed_string Name, class RI>
+        constexpr auto operator[](parallel_policy policy, symbol_substitution<Name, RI, true> substitution) const
+        {
+            return [policy, substitution = std::move(substitution)]
+            <class TExpr, typename Self>(this Self&& self, TExpr&& expr)
+            {
+                return sum_fn{}(policy, substitute((TExpr&&)expr, std::forward_like<Self>(substitution)));
+            };
+        }
+
+        constexpr auto operator[](parallel_policy policy, size_t n) const
+        {
+            return (*this)[policy, i.in[n]];
+        }
     };
 
     void product() = delete;
@@ -519,6 +1029,12 @@ namespace crypto12381::detail
             return product(std::type_identity<std::remove_cvref_t<std::ranges::range_value_t<R>>>{}, std::forward<R>(r));
         }
 
+        template<std::ranges::range R> requires (not symbolic<R>)
+        auto operator()(parallel_policy policy, R&& r) const
+        {
+            return parallel_reduce(product_fn{}, std::forward<R>(r), policy);
+        }
+
         // template<typename F>
         // constexpr auto operator()(size_t n, F&& f) const
         // {
@@ -540,12 +1056,36 @@ namespace crypto12381::detail
         {
             return (*this)[i.in[n]];
         }
+
+        // Π[parallel, n](...) reduces over the threads of parallel
+        template<fixed_string Name, class RI>
+        constexpr auto operator[](parallel_policy policy, symbol_substitution<Name, RI, true> substitution) const
+        {
+            return [policy, substitution = std::move(substitution)]
+            <class TExpr, typename Self>(this Self&& self, TExpr&& expr)
+            {
+                return product_fn{}(policy, substitute((TExpr&&)expr, std::forward_like<Self>(substitution)));
+            };
+        }
+
+        constexpr auto operator[](parallel_policy policy, size_t n) const
+        {
+            return (*this)[policy, i.in[n]];
+        }
     };    
 }
 
 namespace crypto12381
 {
-    inline constexpr detail::hash_fn hash{};
+    inline constexpr detail::hash_fn<> hash{};
+
+    // hash with another hash function, e.g. hash_with<hash_functions::sha256>(...)
+    template<typename Hash>
+    inline constexpr detail::hash_fn<Hash> hash_with{};
+
+    // hash a range of hash states, e.g. hash_each(states).to(G1) hashes them to G1 at once
+    // the states of a borrowed range are forked, the ones of an owned range, e.g. std::move(states), are taken
+    inline constexpr detail::hash_each_fn hash_each{};
     
     inline constexpr detail::sum_fn sum{};
 
@@ -554,6 +1094,13 @@ namespace crypto12381
     inline constexpr auto Σ = sum;
 
     inline constexpr auto Π = product;
+
+    // r | parallel evaluates every element of r once on all threads, e.g. a range of hashes
+    template<std::ranges::range R> requires (not symbolic<R>)
+    auto operator|(R&& r, parallel_policy policy)
+    {
+        return detail::parallel_materialize(std::forward<R>(r), policy);
+    }
 }
 
 namespace crypto12381::detail::sets 
@@ -565,6 +1112,14 @@ namespace crypto12381::detail::sets
         {
             return select_in(constant<Set.base>, random);
         }
+        else if constexpr(requires{ select_in(constant<Set.base>, random, constant<Set.exponent>); })
+        {
+            auto elements = select_in(constant<Set.base>, random, constant<Set.exponent>);
+            const auto iter = std::ranges::begin(elements);
+            return [&]<size_t...I>(std::index_sequence<I...>){
+                return std::tuple{ std::move(iter[I])... };
+            }(std::make_index_sequence<Set.exponent>{});
+        }
         else return [&]<size_t...I>(std::index_sequence<I...>){
             return std::tuple{
                 random-crypto12381::select_in<Set.base^(1 + (I - I))>...
@@ -584,15 +1139,15 @@ namespace crypto12381::detail::sets
     //     }(std::make_index_sequence<Set.exponent>{});
     // }
 
-    template<cartesian_power Set>
-    constexpr auto parse(constant_t<Set>, serialized_view<Set> bytes)
+    template<cartesian_power Set, typename...Cache>
+    constexpr auto parse(constant_t<Set>, serialized_view<Set> bytes, Cache&...cache)
     {
         if constexpr(Set.exponent == 1)
         {
-            return crypto12381::parse<Set.base>(bytes);
+            return crypto12381::parse<Set.base>(bytes, cache...);
         }
         else return [&]<size_t...I>(std::index_sequence<I...>){
-            return crypto12381::parse<cartesian_power{ Set.base, 1uz + (I - I) }...>(bytes);
+            return crypto12381::parse<cartesian_power{ Set.base, 1uz + (I - I) }...>(bytes, cache...);
         }(std::make_index_sequence<Set.exponent>{});
     }
 
@@ -620,12 +1175,16 @@ namespace crypto12381::detail::sets
         return cartesian_product{ l, r };
     }
 
-    template<cartesian_product Set>
-    constexpr auto parse(constant_t<Set>, serialized_view<Set> bytes)
+    template<cartesian_product Set, typename...Cache>
+    constexpr auto parse(constant_t<Set>, serialized_view<Set> bytes, Cache&...cache)
     {
         return std::tuple_cat(
-            std::tuple{ crypto12381::parse<Set.l>(bytes.template subspan<0uz, serialized_size<Set.l>>()) },
-            std::tuple{ crypto12381::parse<Set.r>(bytes.template subspan<serialized_size<Set.l>, serialized_size<Set.r>>()) }
+            std::tuple{ crypto12381::parse<Set.l>(bytes.template subspan<0uz, serialized_size<Set.l>>(), cache...) },
+            std::tuple{ 
+                crypto12381::parse<Set.r>(
+                    bytes.template subspan<serialized_size<Set.l>, serialized_size<Set.r>>(), cache...
+                ) 
+            }
         );
     }
 }
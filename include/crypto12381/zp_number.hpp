@@ -1,11 +1,13 @@
 #ifndef CRYPTO12381_ZP_NUMBER_HPP
 #define CRYPTO12381_ZP_NUMBER_HPP
 
+#include <array>
 #include <cstring>
 #include <cmath>
 #include <stdexcept>
 #include <span>
 #include <limits>
+#include <tuple>
 #include <vector>
 
 #include "miracl_core_interface.hpp"
@@ -57,6 +59,8 @@ namespace crypto12381::detail
 {
     inline constexpr size_t p_bits = 384;
     inline constexpr size_t p_size = p_bits / std::numeric_limits<unsigned char>::digits;
+    // the bits of the largest number in Zp
+    inline constexpr int Zp_number_bits = 255;
     
     inline constexpr size_t chunk_bits = sizeof(size_t) * std::numeric_limits<unsigned char>::digits;
     inline constexpr size_t base_bits = 58uz;
@@ -169,6 +173,40 @@ namespace crypto12381::detail
         return invp2m;
     }
 
+    // the modulus of the base field of G1 and G2
+    inline constexpr ZpNumberData modulus_data = {
+        0x1FEFFFFFFFFAAABL,
+        0x2FFFFAC54FFFFEEL,
+        0x12A0F6B0F6241EAL,
+        0x213CE144AFD9CC3L,
+        0x2434BACD764774BL,
+        0x25FF9A692C6E9EDL,
+        0x1A0111EA3L
+    };
+
+    constexpr ZpNumberData& modulus() noexcept
+    {
+        thread_local constinit auto modulus = modulus_data;
+        return modulus;
+    }
+
+    // the digest of state reduced modulo p, as an element of the base field
+    template<typename Hash>
+    miracl_core::fp digest_residue(basic_hash_state<Hash>&& state) noexcept
+    {
+        constexpr int hash_size = basic_hash_state<Hash>::hash_size;
+        static_assert(hash_size >= 48 && hash_size <= 96, "the digest must be reducible modulo p without bias");
+        char hash_bytes[hash_size];
+        std::move(state).to(hash_bytes);
+        miracl_core::big2 dbig;
+        miracl_core::from_bytes(dbig, hash_bytes, hash_size);
+        miracl_core::big x;
+        miracl_core::fixed_time_mod(x, dbig, modulus(), hash_size * 8 - 381);
+        miracl_core::fp fp;
+        miracl_core::residue(fp, x);
+        return fp;
+    }
+
     struct ZpNumber2Data
     {
         miracl_core::big2 chunks;
@@ -259,6 +297,48 @@ namespace crypto12381::detail
             return result;
         }
 
+        // n numbers drawn with a single request to random_engine
+        static scratch_vector<ZpNumber<Head, Rest>> select(RandomEngine& random_engine, size_t n, bool except0 = false)
+        requires(Head.contains(default_range) && Rest.contains(default_range))
+        {
+            static_assert(sizeof(ZpNumberData) == sizeof(miracl_core::big));
+            scratch_vector<ZpNumberData> numbers(n, scratch_resource());
+            miracl_core::random_in((miracl_core::big*)numbers.data(), n, except0 ? prev_p_data : p_data, random_engine);
+
+            scratch_vector<ZpNumber<Head, Rest>> result{ result_resource() };
+            result.reserve(n);
+            for(auto& number : numbers)
+            {
+                if(except0)
+                {
+                    miracl_core::increase(number, 1);
+                    miracl_core::normalize(number);
+                }
+                result.push_back(data.create<ZpNumber<Head, Rest>>(number));
+            }
+            return result;
+        }
+
+        // N numbers drawn with a single request to random_engine, kept in place
+        template<size_t N>
+        static std::array<ZpNumber<Head, Rest>, N> select(RandomEngine& random_engine, constant_t<N>, bool except0 = false) noexcept
+        requires(Head.contains(default_range) && Rest.contains(default_range))
+        {
+            std::array<ZpNumberData, N> numbers;
+            miracl_core::random_in((miracl_core::big*)numbers.data(), N, except0 ? prev_p_data : p_data, random_engine);
+            if(except0)
+            {
+                for(auto& number : numbers)
+                {
+                    miracl_core::increase(number, 1);
+                    miracl_core::normalize(number);
+                }
+            }
+            return [&]<size_t...I>(std::index_sequence<I...>){
+                return std::array<ZpNumber<Head, Rest>, N>{ data.create<ZpNumber<Head, Rest>>(numbers[I])... };
+            }(std::make_index_sequence<N>{});
+        }
+
         template<typename Self>
         requires (not std::same_as<ZpNumber, Zp_normalized_t>)
         constexpr operator Zp_normalized_t(this Self&& self) noexcept
@@ -535,14 +615,17 @@ namespace crypto12381::detail
             return miracl_core::compare(data(l.normalize()), data(r.normalize())) == 0;
         }
 
-        static Zp_normalized_t from_hash(hash_state&& state) noexcept
+        template<typename Hash>
+        static Zp_normalized_t from_hash(basic_hash_state<Hash>&& state) noexcept
         requires std::same_as<ZpNumber<>, Zp_normalized_t>
         {
+            constexpr int hash_size = basic_hash_state<Hash>::hash_size;
+            static_assert(hash_size >= 48 && hash_size <= 96, "the digest must be reducible modulo r without bias");
             const auto hash_bytes = std::move(state).to();
             miracl_core::big2 dbig;
-            miracl_core::from_bytes(dbig, hash_bytes.data(), hash_state::hash_size);
+            miracl_core::from_bytes(dbig, hash_bytes.data(), hash_size);
             Zp_normalized_t result;
-            miracl_core::fixed_time_mod(result.data_, dbig, p_data, hash_state::hash_size * 8 - 255);
+            miracl_core::fixed_time_mod(result.data_, dbig, p_data, hash_size * 8 - 255);
             return result;
         }
 
@@ -664,6 +747,13 @@ namespace crypto12381::detail
             return std::forward<Self>(self).normalize();
         }
 
+        // the reduction once for all the elements of Σ or Π
+        template<specified<ZpNumber2> Self>
+        friend constexpr ZpNumber<> hoist(Self&& self)
+        {
+            return self.normalize();
+        }
+
         constexpr ZpNumber2<Head> normalize_rests() const noexcept
         {
             auto result = data.create<ZpNumber2<Head>>();
@@ -989,6 +1079,106 @@ namespace crypto12381::detail
             std::forward<T>(t).Zp_number().normalize().serialize(bytes);
         }
     }
+
+    // a public number, the multiplications and exponentiations by it run in variable time
+    template<typename V>
+    class ZpPublic
+    {
+    public:
+        constexpr explicit ZpPublic(V&& number) noexcept
+        : data_{ std::forward<V>(number) }
+        {}
+
+        template<typename Self>
+        constexpr operator Zp_normalized_t(this Self&& self) noexcept
+        {
+            return std::forward<Self>(self).Zp_number();
+        }
+
+        template<typename Self>
+        constexpr decltype(auto) Zp_number(this Self&& self) noexcept
+        {
+            return std::get<0>(std::forward_like<Self>(self.data_)).Zp_number();
+        }
+
+    private:
+        std::tuple<V> data_;
+    };
+
+    template<typename T>
+    inline constexpr bool is_Zp_public = false;
+
+    template<typename V>
+    inline constexpr bool is_Zp_public<ZpPublic<V>> = true;
+
+    template<typename T>
+    concept public_Zp_element = is_Zp_public<std::remove_cvref_t<T>>;
+
+    // a number less than 2^Bits, the multiplications and exponentiations by it
+    // run in constant time in proportion to Bits instead of the bits of p
+    template<size_t Bits>
+    class ZpBounded
+    {
+        friend DataAccessor;
+        static_assert(Bits > 0 && Bits <= 128, "the bounded numbers have at most 128 bits");
+    public:
+        static constexpr int n_bits = (int)Bits;
+
+        constexpr explicit ZpBounded(Zp_normalized_t number)
+        : data_{ std::move(number) }
+        {
+            if(miracl_core::bit_count(data(data_)) > n_bits)
+            {
+                throw std::runtime_error{ "The number exceeds the bound of its bits." };
+            }
+        }
+
+        template<typename Self>
+        constexpr operator Zp_normalized_t(this Self&& self) noexcept
+        {
+            return std::forward_like<Self>(self.data_);
+        }
+
+        template<typename Self>
+        constexpr decltype(auto) Zp_number(this Self&& self) noexcept
+        {
+            return std::forward_like<Self>(self.data_).Zp_number();
+        }
+
+        static ZpBounded select(RandomEngine& random_engine) noexcept
+        {
+            ZpNumberData bound;
+            miracl_core::power_of_two(bound, n_bits);
+            auto number = data.create<Zp_normalized_t>();
+            miracl_core::random_in(data(number), bound, random_engine);
+            return ZpBounded{ std::move(number), unchecked_t{} };
+        }
+
+    private:
+        struct unchecked_t{};
+
+        constexpr ZpBounded(Zp_normalized_t number, unchecked_t) noexcept
+        : data_{ std::move(number) }
+        {}
+
+        Zp_normalized_t data_;
+    };
+
+    template<typename T>
+    inline constexpr bool is_Zp_bounded = false;
+
+    template<size_t Bits>
+    inline constexpr bool is_Zp_bounded<ZpBounded<Bits>> = true;
+
+    template<typename T>
+    concept bounded_Zp_element = is_Zp_bounded<std::remove_cvref_t<T>>;
+
+    // the bits of the numbers of type T
+    template<typename T>
+    inline constexpr int Zp_bound_bits = Zp_number_bits;
+
+    template<size_t Bits>
+    inline constexpr int Zp_bound_bits<ZpBounded<Bits>> = (int)Bits;
 }
 
 namespace crypto12381::detail::sets 
@@ -1003,17 +1193,51 @@ namespace crypto12381::detail::sets
         return detail::ZpNumber<>::select_except0(random);
     }
 
+    inline auto select_in(constant_t<Zp>, RandomEngine& random, size_t n)
+    {
+        return detail::ZpNumber<>::select(random, n) | algebraic;
+    }
+
+    inline auto select_in(constant_t<*Zp>, RandomEngine& random, size_t n)
+    {
+        return detail::ZpNumber<>::select(random, n, true) | algebraic;
+    }
+
+    template<size_t N>
+    inline auto select_in(constant_t<Zp>, RandomEngine& random, constant_t<N> n) noexcept
+    {
+        return detail::ZpNumber<>::select(random, n) | algebraic;
+    }
+
+    template<size_t N>
+    inline auto select_in(constant_t<*Zp>, RandomEngine& random, constant_t<N> n) noexcept
+    {
+        return detail::ZpNumber<>::select(random, n, true) | algebraic;
+    }
+
     constexpr auto parse(constant_t<Zp>, std::span<const char, serialized_size<Zp>> bytes)
     {
         return detail::ZpNumber<>{ bytes };
     }
 
+    template<size_t Bits>
+    constexpr auto select_in(std::integral_constant<Zp_bits_t<Bits>, Zp_bits_t<Bits>{}>, RandomEngine& random) noexcept
+    {
+        return detail::ZpBounded<Bits>::select(random);
+    }
+
+    template<size_t Bits>
+    constexpr auto parse(std::integral_constant<Zp_bits_t<Bits>, Zp_bits_t<Bits>{}>, serialized_view<Zp_bits<Bits>> bytes)
+    {
+        return detail::ZpBounded<Bits>{ detail::ZpNumber<>{ bytes } };
+    }
+
     constexpr auto encode_to(constant_t<Zp>, std::span<const char> message)
     {
         // size of units splited form message
         // 248bits, a number smaller then 255bits(bit count of p)
         constexpr size_t unit_size = 31uz;
-        std::vector<detail::ZpNumber<>> result;
+        detail::scratch_vector<detail::ZpNumber<>> result{ detail::result_resource() };
         result.reserve((message.size() + unit_size - 1) / unit_size);
         
         serialized_field<Zp> buffer{};
@@ -1036,7 +1260,8 @@ namespace crypto12381::detail::sets
         return std::move(result) | algebraic;
     }
 
-    inline auto hash_to(hash_state&& state, Zp_t) noexcept
+    template<typename Hash>
+    inline auto hash_to(basic_hash_state<Hash>&& state, Zp_t) noexcept
     {
         return Zp_normalized_t::from_hash(std::move(state));
     }
@@ -1082,6 +1307,50 @@ namespace crypto12381
         inline constexpr detail::make_Zp_fn make_Zp{};
     }
 
+    namespace detail 
+    {
+        struct vartime_fn : symbolic_functor_interface<vartime_fn>
+        {
+            using symbolic_functor_interface<vartime_fn>::operator();
+
+            template<Zp_element V>
+            static constexpr auto operator()(V&& number) noexcept
+            {
+                return ZpPublic<V>{ std::forward<V>(number) };
+            }
+        };
+    }
+
+    inline namespace functors 
+    {
+        // marks a public number, e.g. g^vartime(c), for the faster variable time algorithms
+        // numbers which must stay secret are never to be marked
+        inline constexpr detail::vartime_fn vartime{};
+    }
+
+    namespace detail 
+    {
+        template<size_t Bits>
+        struct bounded_fn : symbolic_functor_interface<bounded_fn<Bits>>
+        {
+            using symbolic_functor_interface<bounded_fn>::operator();
+
+            template<Zp_element V>
+            static constexpr auto operator()(V&& number)
+            {
+                return ZpBounded<Bits>{ std::forward<V>(number) };
+            }
+        };
+    }
+
+    inline namespace functors 
+    {
+        // declares a number less than 2^Bits, e.g. g^bounded<128>(r) for a short randomizer
+        // throws std::runtime_error for a greater number
+        template<size_t Bits>
+        inline constexpr detail::bounded_fn<Bits> bounded{};
+    }
+
     namespace detail 
     {
         struct polynomial_fn : symbolic_functor_interface<polynomial_fn>
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define CRYPTO12381_SHA256_X86
+#endif
+
+#include <crypto12381/hash_function.hpp>
+
+namespace crypto12381::detail
+{
+    namespace
+    {
+        constexpr std::uint32_t sha256_k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        constexpr std::uint32_t rotate_right(std::uint32_t x, int n) noexcept
+        {
+            return (x >> n) | (x << (32 - n));
+        }
+
+        void compress_portable(std::uint32_t (&h)[8], const unsigned char* blocks, size_t n_blocks) noexcept
+        {
+            for(; n_blocks > 0; --n_blocks, blocks += 64)
+            {
+                std::uint32_t w[64];
+                for(size_t t = 0; t < 16; ++t)
+                {
+                    w[t] = (std::uint32_t)blocks[4 * t] << 24 | (std::uint32_t)blocks[4 * t + 1] << 16
+                         | (std::uint32_t)blocks[4 * t + 2] << 8 | (std::uint32_t)blocks[4 * t + 3];
+                }
+                for(size_t t = 16; t < 64; ++t)
+                {
+                    const auto s0 = rotate_right(w[t - 15], 7) ^ rotate_right(w[t - 15], 18) ^ (w[t - 15] >> 3);
+                    const auto s1 = rotate_right(w[t - 2], 17) ^ rotate_right(w[t - 2], 19) ^ (w[t - 2] >> 10);
+                    w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+                }
+
+                auto a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+                for(size_t t = 0; t < 64; ++t)
+                {
+                    const auto S1 = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+                    const auto ch = (e & f) ^ (~e & g);
+                    const auto temp1 = k + S1 + ch + sha256_k[t] + w[t];
+                    const auto S0 = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+                    const auto maj = (a & b) ^ (a & c) ^ (b & c);
+                    const auto temp2 = S0 + maj;
+                    k = g;
+                    g = f;
+                    f = e;
+                    e = d + temp1;
+                    d = c;
+                    c = b;
+                    b = a;
+                    a = temp1 + temp2;
+                }
+
+                h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+                h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+            }
+        }
+
+#ifdef CRYPTO12381_SHA256_X86
+        __attribute__((target("sha,sse4.1")))
+        void compress_sha_ni(std::uint32_t (&h)[8], const unsigned char* blocks, size_t n_blocks) noexcept
+        {
+            const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+            // the rounds instruction works on (ABEF, CDGH)
+            __m128i temp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&h[0]), 0xB1);
+            __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&h[4]), 0x1B);
+            __m128i state0 = _mm_alignr_epi8(temp, state1, 8);
+            state1 = _mm_blend_epi16(state1, temp, 0xF0);
+
+            for(; n_blocks > 0; --n_blocks, blocks += 64)
+            {
+                const __m128i abef = state0;
+                const __m128i cdgh = state1;
+                __m128i w[4];
+
+                for(int g = 0; g < 16; ++g)
+                {
+                    __m128i message;
+                    if(g < 4)
+                    {
+                        message = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 16 * g)), byte_swap);
+                    }
+                    else
+                    {
+                        message = _mm_sha256msg1_epu32(w[g & 3], w[(g + 1) & 3]);
+                        message = _mm_add_epi32(message, _mm_alignr_epi8(w[(g + 3) & 3], w[(g + 2) & 3], 4));
+                        message = _mm_sha256msg2_epu32(message, w[(g + 3) & 3]);
+                    }
+                    w[g & 3] = message;
+
+                    __m128i rounds = _mm_add_epi32(message, _mm_loadu_si128((const __m128i*)&sha256_k[4 * g]));
+                    state1 = _mm_sha256rnds2_epu32(state1, state0, rounds);
+                    rounds = _mm_shuffle_epi32(rounds, 0x0E);
+                    state0 = _mm_sha256rnds2_epu32(state0, state1, rounds);
+                }
+
+                state0 = _mm_add_epi32(state0, abef);
+                state1 = _mm_add_epi32(state1, cdgh);
+            }
+
+            temp = _mm_shuffle_epi32(state0, 0x1B);
+            state1 = _mm_shuffle_epi32(state1, 0xB1);
+            state0 = _mm_blend_epi16(temp, state1, 0xF0);
+            state1 = _mm_alignr_epi8(state1, temp, 8);
+            _mm_storeu_si128((__m128i*)&h[0], state0);
+            _mm_storeu_si128((__m128i*)&h[4], state1);
+        }
+
+        bool cpu_has_sha_ni() noexcept
+        {
+            unsigned int eax, ebx, ecx, edx;
+            if(not __get_cpuid(1, &eax, &ebx, &ecx, &edx) || not (ecx & bit_SSE4_1) || not (ecx & bit_SSSE3))
+            {
+                return false;
+            }
+            if(not __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            {
+                return false;
+            }
+            return (ebx & bit_SHA) != 0;
+        }
+#endif
+
+        using compress_t = void(*)(std::uint32_t (&)[8], const unsigned char*, size_t) noexcept;
+
+        // selected on the first use, so hashing during the static initialization of another translation unit works
+        compress_t selected_compress() noexcept
+        {
+            static const compress_t compress = []() -> compress_t
+            {
+#ifdef CRYPTO12381_SHA256_X86
+                if(cpu_has_sha_ni())
+                {
+                    return compress_sha_ni;
+                }
+#endif
+                return compress_portable;
+            }();
+            return compress;
+        }
+
+        void compress(std::uint32_t (&h)[8], const unsigned char* blocks, size_t n_blocks) noexcept
+        {
+            selected_compress()(h, blocks, n_blocks);
+        }
+    }
+
+    void sha256_init(sha256_state& state) noexcept
+    {
+        state = sha256_state{
+            .h = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 },
+            .length = 0,
+            .block = {}
+        };
+    }
+
+    void sha256_process(sha256_state& state, std::span<const char> bytes) noexcept
+    {
+        auto data = (const unsigned char*)bytes.data();
+        size_t size = bytes.size();
+        size_t used = state.length % 64;
+        state.length += size;
+
+        if(used != 0)
+        {
+            const size_t n = std::min(size, 64 - used);
+            std::memcpy(state.block + used, data, n);
+            data += n;
+            size -= n;
+            if(used + n < 64)
+            {
+                return;
+            }
+            compress(state.h, state.block, 1);
+        }
+
+        if(size >= 64)
+        {
+            compress(state.h, data, size / 64);
+            data += size / 64 * 64;
+            size %= 64;
+        }
+
+        std::memcpy(state.block, data, size);
+    }
+
+    void sha256_hash(sha256_state& state, char* digest) noexcept
+    {
+        const std::uint64_t n_bits = state.length * 8;
+        unsigned char padding[72] = { 0x80 };
+        const size_t used = state.length % 64;
+        const size_t padding_size = (used < 56 ? 56 - used : 120 - used);
+        for(size_t i = 0; i < 8; ++i)
+        {
+            padding[padding_size + i] = (unsigned char)(n_bits >> (56 - 8 * i));
+        }
+        sha256_process(state, std::span{ (const char*)padding, padding_size + 8 });
+
+        for(size_t i = 0; i < 8; ++i)
+        {
+            digest[4 * i]     = (char)(state.h[i] >> 24);
+            digest[4 * i + 1] = (char)(state.h[i] >> 16);
+            digest[4 * i + 2] = (char)(state.h[i] >> 8);
+            digest[4 * i + 3] = (char)(state.h[i]);
+        }
+    }
+
+    void sha256_expand_message_xmd(sha256_state& state, std::span<const char> domain, std::span<char> output) noexcept
+    {
+        // DST_prime = DST || I2OSP(len(DST), 1)
+        const char domain_size = (char)domain.size();
+        auto process_domain = [&](sha256_state& s)
+        {
+            sha256_process(s, domain);
+            sha256_process(s, std::span{ &domain_size, 1 });
+        };
+
+        // b_0 = H(Z_pad || msg || I2OSP(len_in_bytes, 2) || I2OSP(0, 1) || DST_prime)
+        const char sizes[3] = { (char)(output.size() >> 8), (char)output.size(), 0 };
+        sha256_process(state, std::span{ sizes });
+        process_domain(state);
+        char b_0[32];
+        sha256_hash(state, b_0);
+
+        // b_i = H(strxor(b_0, b_(i - 1)) || I2OSP(i, 1) || DST_prime), with b_1 = H(b_0 || I2OSP(1, 1) || DST_prime)
+        char b_i[32] = {};
+        for(size_t i = 1, offset = 0; offset < output.size(); ++i, offset += 32)
+        {
+            for(size_t j = 0; j < 32; ++j)
+            {
+                b_i[j] ^= b_0[j];
+            }
+            const char index = (char)i;
+            sha256_state block;
+            sha256_init(block);
+            sha256_process(block, std::span{ b_i });
+            sha256_process(block, std::span{ &index, 1 });
+            process_domain(block);
+            sha256_hash(block, b_i);
+            std::memcpy(output.data() + offset, b_i, std::min(32uz, output.size() - offset));
+            secure_zero(&block, sizeof(block));
+        }
+        secure_zero(b_0, sizeof(b_0));
+        secure_zero(b_i, sizeof(b_i));
+    }
+
+    void secure_zero(void* p, size_t size) noexcept
+    {
+        volatile auto bytes = (volatile unsigned char*)p;
+        for(size_t i = 0; i < size; ++i)
+        {
+            bytes[i] = 0;
+        }
+    }
+
+    bool sha256_accelerated() noexcept
+    {
+#ifdef CRYPTO12381_SHA256_X86
+        return selected_compress() == compress_sha_ni;
+#else
+        return false;
+#endif
+    }
+}
@@ -1,12 +1,30 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
 #include <miracl-core/bls_BLS12381.h>
 #include <miracl-core/randapi.h>
 
+#include <crypto12381/arena.hpp>
+#include <crypto12381/explain.hpp>
 #include <crypto12381/miracl_core_interface.hpp>
 
 using namespace core;
 using namespace BLS12381;
 using namespace BLS12381_BIG;
 
+using crypto12381::detail::scratch_resource;
+using crypto12381::detail::scratch_vector;
+using crypto12381::detail::note;
+using crypto12381::EvaluationPlan;
+
 namespace crypto12381::detail::miracl_core
 {
     void sha3_init(sha3_state& state, int output_size) noexcept
@@ -57,6 +75,17 @@ namespace crypto12381::detail::miracl_core
         return BIG_comp(l, r);
     }
 
+    int bit_count(const big& value) noexcept
+    {
+        return BIG_nbits(value);
+    }
+
+    void power_of_two(big& result, int n) noexcept
+    {
+        BIG_one(result);
+        BIG_shl(result, n);
+    }
+
     void to_bytes(char* result, const big& value) noexcept
     {
         BIG_toBytes(result, value);
@@ -64,8 +93,46 @@ namespace crypto12381::detail::miracl_core
 
     void random_in(big& result, const big& modulus, RandomEngine& random) noexcept
     {
-        const auto rng = (core::csprng*)random.impl();
-        BIG_randomnum(result, modulus, rng);
+        random_in(&result, 1, modulus, random);
+    }
+
+    void random_in(big* results, size_t n, const big& modulus, RandomEngine& random) noexcept
+    {
+        if(random.backend() == random_backend::csprng)
+        {
+            const auto rng = (core::csprng*)random.impl();
+            for(size_t i = 0; i < n; ++i)
+            {
+                BIG_randomnum(results[i], modulus, rng);
+            }
+            return;
+        }
+
+        // rejection sampling, draw numbers of the bit length of modulus until they are below it
+        const int n_bits = BIG_nbits(modulus);
+        const int unit_size = (n_bits + 7) / 8;
+        const char top_mask = (char)(0xff >> (8 * unit_size - n_bits));
+        // the few numbers of a small structure draw their bytes on the stack
+        alignas(std::max_align_t) char stack_bytes[16 * 48];
+        std::pmr::monotonic_buffer_resource stack_resource{ stack_bytes, sizeof(stack_bytes), scratch_resource() };
+        scratch_vector<char> bytes{ &stack_resource };
+        for(size_t i = 0; i < n;)
+        {
+            bytes.resize((n - i) * unit_size);
+            random.fill(bytes);
+            for(size_t offset = 0; offset < bytes.size(); offset += unit_size)
+            {
+                bytes[offset] &= top_mask;
+                BIG_fromBytesLen(results[i], bytes.data() + offset, unit_size);
+
+                // constant time comparison, only whether the number is rejected is observable
+                BIG difference;
+                BIG_sub(difference, results[i], modulus);
+                BIG_norm(difference);
+                i += (difference[NLEN_B384_58 - 1] < 0);
+            }
+        }
+        std::memset(bytes.data(), 0, bytes.size());
     }
 
     void multiply(big2& result, const big& l, const big& r) noexcept
@@ -85,6 +152,7 @@ namespace crypto12381::detail::miracl_core
 
     void mod_inverse(big& result, big& value, const big& modulus) noexcept
     {
+        note(&EvaluationPlan::Zp_and_batch_inversions);
         BIG_invmodp(result, value, modulus);
     }
 
@@ -104,18 +172,1483 @@ namespace crypto12381::detail::miracl_core
     }
 }
 
+namespace
+{
+    static_assert(PM1D2_BLS12381 == 1, "the square roots below assume p = 3 mod 4");
+
+    // (p - 3) / 4, the exponent of the progenitor of x, which gives both the square root and the inverse of x
+    constexpr char progenitor_exponent[] = 
+        "0680447a8e5ff9a692c6e9ed90d2eb35d91dd2e13ce144afd9cc34a83dac3d8907aaffffac54ffffee7fbfffffffeaaa";
+
+    // r = r^(2^squarings) * x^power for each step, power is odd and less than 2^progenitor_window
+    struct chain_step
+    {
+        int squarings;
+        int power;
+    };
+
+    constexpr int progenitor_window = 5;
+
+    struct progenitor_chain_t
+    {
+        chain_step steps[96];
+        int n_steps;
+        int trailing_squarings;
+    };
+
+    // the sliding window chain of progenitor_exponent, fixed at compile time unlike FP_pow which
+    // recodes the exponent on every call
+    constexpr progenitor_chain_t progenitor_chain = []()
+    {
+        constexpr int n_bits = 4 * (sizeof(progenitor_exponent) - 1);
+        auto bit = [](int i)
+        {
+            const char digit = progenitor_exponent[i / 4];
+            const int value = digit <= '9' ? digit - '0' : digit - 'a' + 10;
+            return (value >> (3 - i % 4)) & 1;
+        };
+
+        progenitor_chain_t chain{};
+        int pending = 0;
+        for(int i = 0; i < n_bits;)
+        {
+            if(bit(i) == 0)
+            {
+                pending += chain.n_steps != 0;
+                ++i;
+                continue;
+            }
+
+            int j = std::min(i + progenitor_window, n_bits);
+            while(bit(j - 1) == 0)
+            {
+                --j;
+            }
+            int power = 0;
+            for(int k = i; k < j; ++k)
+            {
+                power = power * 2 + bit(k);
+            }
+            chain.steps[chain.n_steps] = { chain.n_steps == 0 ? 0 : pending + (j - i), power };
+            ++chain.n_steps;
+            pending = 0;
+            i = j;
+        }
+        chain.trailing_squarings = pending;
+        return chain;
+    }();
+
+    // r = x^((p - 3) / 4)
+    void progenitor(FP* r, FP* x) noexcept
+    {
+        // table[i] = x^(2i + 1)
+        FP table[1 << (progenitor_window - 1)];
+        FP x2;
+        FP_copy(&table[0], x);
+        FP_norm(&table[0]);
+        FP_sqr(&x2, &table[0]);
+        for(size_t i = 1; i < std::size(table); ++i)
+        {
+            FP_mul(&table[i], &table[i - 1], &x2);
+        }
+
+        FP_copy(r, &table[progenitor_chain.steps[0].power / 2]);
+        for(int i = 1; i < progenitor_chain.n_steps; ++i)
+        {
+            const auto& step = progenitor_chain.steps[i];
+            for(int j = 0; j < step.squarings; ++j)
+            {
+                FP_sqr(r, r);
+            }
+            FP_mul(r, r, &table[step.power / 2]);
+        }
+        for(int j = 0; j < progenitor_chain.trailing_squarings; ++j)
+        {
+            FP_sqr(r, r);
+        }
+        FP_reduce(r);
+    }
+
+    // same as FP_qr, return 1 if x is a square, hint = the progenitor of x for FP_sqrt and FP_inv
+    int is_square(FP* x, FP* hint) noexcept
+    {
+        FP r;
+        progenitor(hint, x);
+        FP_sqr(&r, hint);
+        FP_mul(&r, x, &r);
+        return FP_isunity(&r);
+    }
+
+    // same as FP2_sqrt, with norm = a^2 + b^2 of u = a + ib and hint = the progenitor of norm
+    void fp2_sqrt(FP2* w, FP2* u, FP* norm, FP* hint) noexcept
+    {
+        FP w1, w2, w3, w4, half_hint;
+        FP2 nw;
+        FP2_copy(w, u);
+        if(FP2_iszilch(w))
+        {
+            return;
+        }
+
+        // sqrt(a + ib) = sqrt((a + sqrt(a^2 + b^2)) / 2) + ib / (2 * sqrt((a + sqrt(a^2 + b^2)) / 2))
+        FP_sqrt(&w1, norm, hint);
+        FP_add(&w2, &(w->a), &w1);
+        FP_norm(&w2);
+        FP_div2(&w2, &w2);
+        FP_div2(&w1, &(w->b));
+        const int qr = is_square(&w2, &half_hint);
+
+        // otherwise -w2 is a square, and -1 is a non-residue
+        FP_neg(&w3, &half_hint);
+        FP_norm(&w3);
+        FP_neg(&w4, &w2);
+        FP_norm(&w4);
+        FP_cmove(&w2, &w4, 1 - qr);
+        FP_cmove(&half_hint, &w3, 1 - qr);
+
+        FP_sqrt(&(w->a), &w2, &half_hint);
+        FP_inv(&w3, &w2, &half_hint);
+        FP_mul(&w3, &w3, &(w->a));
+        FP_mul(&(w->b), &w3, &w1);
+        FP_copy(&w4, &(w->a));
+        FP_cmove(&(w->a), &(w->b), 1 - qr);
+        FP_cmove(&(w->b), &w4, 1 - qr);
+
+        const int sign = FP2_sign(w);
+        FP2_neg(&nw, w);
+        FP2_norm(&nw);
+        FP2_cmove(w, &nw, sign);
+    }
+}
+
+namespace
+{
+    // P = |x| * P for the curve parameter x, double and add over the 6 set bits of the public |x|
+    void multiply_by_curve_parameter(ECP* P) noexcept
+    {
+        BIG x;
+        BIG_rcopy(x, CURVE_Bnx);
+        ECP Q;
+        ECP_copy(&Q, P);
+        for(int i = BIG_nbits(x) - 2; i >= 0; --i)
+        {
+            ECP_dbl(P);
+            if(BIG_bit(x, i))
+            {
+                ECP_add(P, &Q);
+            }
+        }
+    }
+
+    void multiply_by_curve_parameter(ECP2* P) noexcept
+    {
+        BIG x;
+        BIG_rcopy(x, CURVE_Bnx);
+        ECP2 Q;
+        ECP2_copy(&Q, P);
+        for(int i = BIG_nbits(x) - 2; i >= 0; --i)
+        {
+            ECP2_dbl(P);
+            if(BIG_bit(x, i))
+            {
+                ECP2_add(P, &Q);
+            }
+        }
+    }
+
+    // the frobenius constant of ECP2_cfp, inverted for the M-type twist
+    void get_cofactor_frobenius(FP2* X) noexcept
+    {
+        FP2_rcopy(X, Fra, Frb);
+#if SEXTIC_TWIST_BLS12381 == M_TYPE
+        FP2_inv(X, X, NULL);
+        FP2_norm(X);
+#endif
+    }
+
+    // Q = x^2 Q - x Q - Q + psi(x Q - Q) + psi^2(2 Q) as ECP2_cfp (Budroni, Pintore)
+    // with the chain of the public |x| instead of the windows of ECP2_mul
+    void clear_cofactor(ECP2* Q, FP2* X) noexcept
+    {
+        static_assert(SIGN_OF_X_BLS12381 == NEGATIVEX, "the map to G2 below assumes a negative x");
+
+        ECP2 xQ, x2Q;
+        ECP2_copy(&xQ, Q);
+        multiply_by_curve_parameter(&xQ);
+        ECP2_copy(&x2Q, &xQ);
+        multiply_by_curve_parameter(&x2Q);
+        ECP2_neg(&xQ);
+
+        ECP2_sub(&x2Q, &xQ);
+        ECP2_sub(&x2Q, Q);
+
+        ECP2_sub(&xQ, Q);
+        ECP2_frob(&xQ, X);
+
+        ECP2_dbl(Q);
+        ECP2_frob(Q, X);
+        ECP2_frob(Q, X);
+
+        ECP2_add(Q, &x2Q);
+        ECP2_add(Q, &xQ);
+    }
+}
+
+namespace
+{
+    static_assert(HTC_ISO_BLS12381 == 11, "the map to G1 below assumes the 11-isogeny");
+
+    // the constants of the simplified swu map to the isogenous curve and of the isogeny, converted to FP once
+    struct isogeny_constants
+    {
+        static constexpr int iso = HTC_ISO_BLS12381;
+        static constexpr int n_coefficients = (iso + 1) + (iso - 1) + (3 * (iso - 1) / 2 + 1) + 3 * (iso - 1) / 2;
+
+        FP A;
+        FP B;
+        FP htpc;
+        FP pc[n_coefficients];
+
+        isogeny_constants() noexcept
+        {
+            FP_rcopy(&A, CURVE_Ad);
+            FP_rcopy(&B, CURVE_Bd);
+            FP_rcopy(&htpc, CURVE_HTPC);
+            for(int k = 0; k < n_coefficients; ++k)
+            {
+                FP_rcopy(&pc[k], PC[k]);
+            }
+        }
+    };
+
+    // r = Σ(c[i] * x^(n - i)) for i in [n + 1], with the leading coefficient 1 for monic polynomials
+    void horner(FP* r, FP* x, FP* c, int n, bool monic) noexcept
+    {
+        if(monic)
+        {
+            FP_copy(r, x);
+            FP_add(r, r, &c[0]);
+            FP_norm(r);
+        }
+        else
+        {
+            FP_copy(r, &c[0]);
+        }
+        for(int i = 1; i <= n - monic; ++i)
+        {
+            FP_mul(r, r, x);
+            FP_add(r, r, &c[i]);
+            FP_norm(r);
+        }
+    }
+
+    // same as ECP_map2point, with the constants in c and the fixed chain of progenitor for the square test
+    void map_to_curve(ECP* P, const FP* h, isogeny_constants& c) noexcept
+    {
+        FP one, t, w, D, D2, X1, X2, X3, GX1, Y, hint;
+        FP_one(&one);
+        FP_copy(&t, h);
+        const int sgn = FP_sign(&t);
+
+        // x = -B * (Z^2 * t^4 + Z * t^2 + 1) / (A * (Z^2 * t^4 + Z * t^2)), or Z * t^2 times it
+        FP_sqr(&t, &t);
+        FP_imul(&t, &t, RIADZ_BLS12381);
+        FP_add(&w, &t, &one);
+        FP_norm(&w);
+        FP_mul(&w, &w, &t);
+        FP_mul(&D, &c.A, &w);
+        FP_add(&w, &w, &one);
+        FP_norm(&w);
+        FP_mul(&w, &w, &c.B);
+        FP_neg(&w, &w);
+        FP_norm(&w);
+        FP_copy(&X2, &w);
+        FP_mul(&X3, &t, &X2);
+
+        // g(x) = x^3 + A * x + B over the denominator D^3
+        FP_sqr(&GX1, &X2);
+        FP_sqr(&D2, &D);
+        FP_mul(&w, &c.A, &D2);
+        FP_add(&GX1, &GX1, &w);
+        FP_norm(&GX1);
+        FP_mul(&GX1, &GX1, &X2);
+        FP_mul(&D2, &D2, &D);
+        FP_mul(&w, &c.B, &D2);
+        FP_add(&GX1, &GX1, &w);
+        FP_norm(&GX1);
+
+        // one progenitor gives the square test, the inverse of D and the square root
+        FP_mul(&w, &GX1, &D);
+        const int qr = is_square(&w, &hint);
+        FP_inv(&D, &w, &hint);
+        FP_mul(&D, &D, &GX1);
+        FP_mul(&X2, &X2, &D);
+        FP_mul(&X3, &X3, &D);
+        FP_mul(&t, &t, h);
+        FP_sqr(&D2, &D);
+        FP_mul(&D, &D2, &t);
+        FP_imul(&t, &w, RIADZ_BLS12381);
+        FP_mul(&X1, &c.htpc, &hint);
+
+        FP_cmove(&X2, &X3, 1 - qr);
+        FP_cmove(&D2, &D, 1 - qr);
+        FP_cmove(&w, &t, 1 - qr);
+        FP_cmove(&hint, &X1, 1 - qr);
+
+        FP_sqrt(&Y, &w, &hint);
+        FP_mul(&Y, &Y, &D2);
+        const int ne = FP_sign(&Y) ^ sgn;
+        FP_neg(&w, &Y);
+        FP_norm(&w);
+        FP_cmove(&Y, &w, ne);
+
+        // the isogeny in projective coordinates
+        constexpr int iso = isogeny_constants::iso;
+        constexpr int isoy = 3 * (iso - 1) / 2;
+        FP xnum, xden, ynum, yden;
+        FP* pc = c.pc;
+        horner(&xnum, &X2, pc, iso, false);
+        pc += iso + 1;
+        horner(&xden, &X2, pc, iso - 1, true);
+        pc += iso - 1;
+        horner(&ynum, &X2, pc, isoy, false);
+        pc += isoy + 1;
+        horner(&yden, &X2, pc, isoy, true);
+        FP_mul(&ynum, &ynum, &Y);
+
+        FP_mul(&(P->x), &xnum, &yden);
+        FP_mul(&(P->y), &ynum, &xden);
+        FP_mul(&(P->z), &xden, &yden);
+    }
+}
+
+namespace
+{
+    // the group operations of the variable time multiplications below, written additively for FP12 too
+    void set_identity(ECP* P) noexcept
+    {
+        ECP_inf(P);
+    }
+
+    void set_identity(ECP2* P) noexcept
+    {
+        ECP2_inf(P);
+    }
+
+    void set_identity(FP12* P) noexcept
+    {
+        FP12_one(P);
+    }
+
+    void twice(ECP* P) noexcept
+    {
+        ECP_dbl(P);
+    }
+
+    void twice(ECP2* P) noexcept
+    {
+        ECP2_dbl(P);
+    }
+
+    // the elements of GT are unitary
+    void twice(FP12* P) noexcept
+    {
+        FP12_usqr(P, P);
+    }
+
+    void add_to(ECP* P, ECP* Q) noexcept
+    {
+        ECP_add(P, Q);
+    }
+
+    void add_to(ECP2* P, ECP2* Q) noexcept
+    {
+        ECP2_add(P, Q);
+    }
+
+    void add_to(FP12* P, FP12* Q) noexcept
+    {
+        FP12_mul(P, Q);
+    }
+
+    void sub_from(ECP* P, ECP* Q) noexcept
+    {
+        ECP_sub(P, Q);
+    }
+
+    void sub_from(ECP2* P, ECP2* Q) noexcept
+    {
+        ECP2_sub(P, Q);
+    }
+
+    // the inverse of a unitary element is its conjugate
+    void sub_from(FP12* P, FP12* Q) noexcept
+    {
+        FP12 T;
+        FP12_conj(&T, Q);
+        FP12_mul(P, &T);
+    }
+
+    void negate(ECP* P) noexcept
+    {
+        ECP_neg(P);
+    }
+
+    void negate(ECP2* P) noexcept
+    {
+        ECP2_neg(P);
+    }
+
+    void negate(FP12* P) noexcept
+    {
+        FP12_conj(P, P);
+    }
+
+    void frobenius(ECP2* P, FP2* X) noexcept
+    {
+        ECP2_frob(P, X);
+    }
+
+    void frobenius(FP12* P, FP2* X) noexcept
+    {
+        FP12_frob(P, X);
+    }
+
+    // r = k mod q for the group order q
+    void reduce_scalar(BIG r, const BIG k) noexcept
+    {
+        BIG q;
+        BIG_rcopy(q, CURVE_Order);
+        BIG_copy(r, k);
+        BIG_norm(r);
+        BIG_mod(r, q);
+    }
+
+    constexpr int max_wnaf_digits = NLEN_B384_58 * BASEBITS_B384_58 + 1;
+
+    // the width w non-adjacent form of k, least significant digit first, return the number of digits
+    // each digit is 0 or odd and less than 2^(w - 1) in absolute value, k is destroyed
+    int to_wnaf(signed char* digits, BIG k, int w) noexcept
+    {
+        int n = 0;
+        BIG_norm(k);
+        while(!BIG_iszilch(k))
+        {
+            int digit = 0;
+            if(BIG_parity(k))
+            {
+                digit = BIG_lastbits(k, w);
+                if(digit >= 1 << (w - 1))
+                {
+                    digit -= 1 << w;
+                }
+                if(digit > 0)
+                {
+                    BIG_dec(k, digit);
+                }
+                else
+                {
+                    BIG_inc(k, -digit);
+                }
+                BIG_norm(k);
+            }
+            digits[n++] = (signed char)digit;
+            BIG_fshr(k, 1);
+        }
+        return n;
+    }
+
+    // the width of the nafs of scalars of n_bits bits and the additions for each scalar, counting its table
+    std::pair<int, long> wnaf_window(int n_bits) noexcept
+    {
+        std::pair<int, long> best{ 0, std::numeric_limits<long>::max() };
+        for(int w = 2; w <= 7; ++w)
+        {
+            const long cost = n_bits / (w + 1) + (1 << (w - 2));
+            if(cost < best.second)
+            {
+                best = { w, cost };
+            }
+        }
+        return best;
+    }
+
+    // r = Σ(k[i] * bases[i]) for i in [n] with interleaved nafs, in variable time, the k[i] are destroyed
+    template<typename T>
+    void interleaved_wnaf(T* r, int n, T* bases, BIG* k)
+    {
+        int n_bits = 0;
+        for(int i = 0; i < n; ++i)
+        {
+            BIG_norm(k[i]);
+            n_bits = std::max(n_bits, BIG_nbits(k[i]));
+        }
+        const int w = wnaf_window(n_bits).first;
+        const int table_size = 1 << (w - 2);
+
+        // table[i * table_size + j] = (2j + 1) * bases[i]
+        scratch_vector<T> table(n * table_size, scratch_resource());
+        scratch_vector<signed char> digits(n * max_wnaf_digits, scratch_resource());
+        int length = 0;
+        for(int i = 0; i < n; ++i)
+        {
+            const int n_digits = to_wnaf(&digits[i * max_wnaf_digits], k[i], w);
+            if(n_digits == 0)
+            {
+                continue;
+            }
+            length = std::max(length, n_digits);
+
+            T* row = &table[i * table_size];
+            T base2 = bases[i];
+            twice(&base2);
+            row[0] = bases[i];
+            for(int j = 1; j < table_size; ++j)
+            {
+                row[j] = row[j - 1];
+                add_to(&row[j], &base2);
+            }
+        }
+
+        // r stays the identity until the first nonzero digit, which is copied instead of added
+        set_identity(r);
+        bool started = false;
+        for(int j = length - 1; j >= 0; --j)
+        {
+            if(started)
+            {
+                twice(r);
+            }
+            for(int i = 0; i < n; ++i)
+            {
+                const int digit = digits[i * max_wnaf_digits + j];
+                if(digit > 0 && !started)
+                {
+                    *r = table[i * table_size + digit / 2];
+                    started = true;
+                }
+                else if(digit > 0)
+                {
+                    add_to(r, &table[i * table_size + digit / 2]);
+                }
+                else if(digit < 0)
+                {
+                    sub_from(r, &table[i * table_size + -digit / 2]);
+                    started = true;
+                }
+            }
+        }
+    }
+
+    // the window of bucket_method for n scalars of n_bits bits and its additions
+    std::pair<int, long> bucket_window(long n, int n_bits) noexcept
+    {
+        std::pair<int, long> best{ 0, std::numeric_limits<long>::max() };
+        for(int c = 2; c <= 16; ++c)
+        {
+            // the signed digits carry into one more window, each window aggregates 2^(c - 1) buckets twice
+            const long cost = (n_bits / c + 1) * (n + (1l << c));
+            if(cost < best.second)
+            {
+                best = { c, cost };
+            }
+        }
+        return best;
+    }
+
+    // r = Σ(k[i] * bases[i]) for i in [n] with signed buckets of window c, in variable time
+    template<typename T>
+    void bucket_method(T* r, int n, T* bases, BIG* k, int n_bits, int c)
+    {
+        const int n_windows = n_bits / c + 1;
+        const int half = 1 << (c - 1);
+
+        // digits[i * n_windows + w] in [-2^(c - 1), 2^(c - 1)] with k[i] = Σ(digits[i * n_windows + w] * 2^(cw))
+        scratch_vector<int> digits(n * n_windows, scratch_resource());
+        for(int i = 0; i < n; ++i)
+        {
+            int carry = 0;
+            for(int w = 0; w < n_windows; ++w)
+            {
+                int digit = carry;
+                for(int b = 0; b < c && w * c + b < n_bits; ++b)
+                {
+                    digit += BIG_bit(k[i], w * c + b) << b;
+                }
+                carry = digit > half;
+                digits[i * n_windows + w] = digit - (carry << c);
+            }
+        }
+
+        scratch_vector<T> buckets(half, scratch_resource());
+        scratch_vector<char> used(half, scratch_resource());
+        set_identity(r);
+        for(int w = n_windows - 1; w >= 0; --w)
+        {
+            for(int b = 0; b < c && w != n_windows - 1; ++b)
+            {
+                twice(r);
+            }
+
+            std::fill(used.begin(), used.end(), 0);
+            for(int i = 0; i < n; ++i)
+            {
+                const int digit = digits[i * n_windows + w];
+                if(digit == 0)
+                {
+                    continue;
+                }
+                T& bucket = buckets[std::abs(digit) - 1];
+                if(!used[std::abs(digit) - 1])
+                {
+                    used[std::abs(digit) - 1] = 1;
+                    set_identity(&bucket);
+                }
+                if(digit > 0)
+                {
+                    add_to(&bucket, &bases[i]);
+                }
+                else
+                {
+                    sub_from(&bucket, &bases[i]);
+                }
+            }
+
+            // Σ((j + 1) * buckets[j]) as the sum of the running sums from the top bucket
+            T running, window;
+            set_identity(&running);
+            set_identity(&window);
+            bool started = false;
+            for(int j = half - 1; j >= 0; --j)
+            {
+                if(used[j])
+                {
+                    add_to(&running, &buckets[j]);
+                    started = true;
+                }
+                if(started)
+                {
+                    add_to(&window, &running);
+                }
+            }
+            if(started)
+            {
+                add_to(r, &window);
+            }
+        }
+    }
+
+    // k = u[0] + x^2 * u[1] for the reduced k, and -x^2 * P = (cru * P.x, P.y)
+    void glv_split(BIG u[2], const BIG k) noexcept
+    {
+        BIG x, x2;
+        BIG_rcopy(x, CURVE_Bnx);
+        BIG_smul(x2, x, x);
+        reduce_scalar(u[0], k);
+        BIG_copy(u[1], u[0]);
+        BIG_mod(u[0], x2);
+        BIG_sdiv(u[1], x2);
+    }
+
+    // bases[0] = P and bases[1] = x^2 * P, the multipliers of the halves of glv_split
+    void glv_bases(ECP bases[2], const ECP* P) noexcept
+    {
+        FP cru;
+        FP_rcopy(&cru, CRu);
+        bases[0] = *P;
+        bases[1] = *P;
+        FP_mul(&(bases[1].x), &(bases[1].x), &cru);
+        ECP_neg(&bases[1]);
+    }
+
+    // k = Σ(u[i] * |x|^i) for i in [4] for the reduced k
+    void gs_split(BIG u[4], const BIG k) noexcept
+    {
+        BIG x, w;
+        BIG_rcopy(x, CURVE_Bnx);
+        reduce_scalar(w, k);
+        for(int i = 0; i < 3; ++i)
+        {
+            BIG_copy(u[i], w);
+            BIG_mod(u[i], x);
+            BIG_sdiv(w, x);
+        }
+        BIG_copy(u[3], w);
+    }
+
+    // bases[i] = |x|^i * P for i in [n] with the frobenius endomorphism, which multiplies the elements of order q by x
+    template<typename T>
+    void gs_bases(T* bases, int n, FP2* X) noexcept
+    {
+        for(int i = 1; i < n; ++i)
+        {
+            bases[i] = bases[i - 1];
+            frobenius(&bases[i], X);
+        }
+#if SIGN_OF_X_BLS12381 == NEGATIVEX
+        for(int i = 1; i < n; i += 2)
+        {
+            negate(&bases[i]);
+        }
+#endif
+    }
+
+    void frobenius_constant(FP2* X) noexcept
+    {
+        FP fx, fy;
+        FP_rcopy(&fx, Fra);
+        FP_rcopy(&fy, Frb);
+        FP2_from_FPs(X, &fx, &fy);
+    }
+
+    // the frobenius constant of psi on the twist
+    void psi_constant(FP2* X) noexcept
+    {
+        frobenius_constant(X);
+#if SEXTIC_TWIST_BLS12381 == M_TYPE
+        FP2_inv(X, X, NULL);
+        FP2_norm(X);
+#endif
+    }
+}
+
+namespace
+{
+    // the constant time multiplications below by numbers of a public bit length
+    void conditional_move(ECP* P, ECP* Q, int d) noexcept
+    {
+        FP_cmove(&(P->x), &(Q->x), d);
+        FP_cmove(&(P->y), &(Q->y), d);
+        FP_cmove(&(P->z), &(Q->z), d);
+    }
+
+    void conditional_move(ECP2* P, ECP2* Q, int d) noexcept
+    {
+        FP2_cmove(&(P->x), &(Q->x), d);
+        FP2_cmove(&(P->y), &(Q->y), d);
+        FP2_cmove(&(P->z), &(Q->z), d);
+    }
+
+    void conditional_move(FP12* P, FP12* Q, int d) noexcept
+    {
+        FP12_cmove(P, Q, d);
+    }
+
+    // return 1 if b == c else return 0, without branching
+    int is_equal(int b, int c) noexcept
+    {
+        int x = b ^ c;
+        x -= 1;
+        return (x >> 31) & 1;
+    }
+
+    // P = table[(|b| - 1) / 2], negated for negative b, for odd b reading all of the 8 entries
+    template<typename T>
+    void select(T* P, T table[8], int b) noexcept
+    {
+        const int m = b >> 31;
+        const int index = (((b ^ m) - m) - 1) / 2;
+        for(int i = 0; i < 8; ++i)
+        {
+            conditional_move(P, &table[i], is_equal(index, i));
+        }
+        T N = *P;
+        negate(&N);
+        conditional_move(P, &N, m & 1);
+    }
+
+    // t = k + 1 for even k and k + 2 for odd k, return 1 if P is to be taken back and 0 for 2 * P
+    int make_odd(BIG t, const BIG k) noexcept
+    {
+        BIG mt;
+        BIG_copy(t, k);
+        BIG_norm(t);
+        const int s = BIG_parity(t);
+        BIG_inc(t, 1);
+        BIG_norm(t);
+        const int ns = BIG_parity(t);
+        BIG_copy(mt, t);
+        BIG_inc(mt, 1);
+        BIG_norm(mt);
+        BIG_cmove(t, mt, s);
+        return ns;
+    }
+
+    // r[i] = k * r[i] for i in [n] and k < 2^n_bits with signed 4-bit windows, the time depends on n and n_bits only as ECP_clmul
+    // the windows of k are recoded once for all points
+    template<typename T>
+    void fixed_window(T* r, size_t n, const BIG k, int n_bits) noexcept
+    {
+        BIG t;
+        const int ns = make_odd(t, k);
+
+        signed char w[max_wnaf_digits];
+        const int nb = 1 + (n_bits + 3) / 4;
+        for(int i = 0; i < nb; ++i)
+        {
+            w[i] = (signed char)(BIG_lastbits(t, 5) - 16);
+            BIG_dec(t, w[i]);
+            BIG_norm(t);
+            BIG_fshr(t, 4);
+        }
+        w[nb] = (signed char)BIG_lastbits(t, 5);
+
+        for(size_t p = 0; p < n; ++p)
+        {
+            T table[8], Q, C;
+            table[0] = r[p];
+            Q = r[p];
+            twice(&Q);
+            for(int i = 1; i < 8; ++i)
+            {
+                table[i] = table[i - 1];
+                add_to(&table[i], &Q);
+            }
+            C = Q;
+            conditional_move(&C, &r[p], ns);
+
+            select(&r[p], table, w[nb]);
+            for(int i = nb - 1; i >= 0; --i)
+            {
+                select(&Q, table, w[i]);
+                for(int j = 0; j < 4; ++j)
+                {
+                    twice(&r[p]);
+                }
+                add_to(&r[p], &Q);
+            }
+            sub_from(&r[p], &C);
+        }
+    }
+
+    // r[i] = e * r[i] + f * q[i] for i in [n] and e, f < 2^n_bits with joint signed 2-bit windows as ECP_clmul2
+    // the windows of e and f are recoded once for all points
+    template<typename T>
+    void joint_window(T* r, T* q, size_t n, const BIG e, const BIG f, int n_bits) noexcept
+    {
+        BIG te, tf;
+        const int ns_e = make_odd(te, e);
+        const int ns_f = make_odd(tf, f);
+
+        signed char w[max_wnaf_digits];
+        const int nb = 1 + (n_bits + 1) / 2;
+        for(int i = 0; i < nb; ++i)
+        {
+            const int a = BIG_lastbits(te, 3) - 4;
+            BIG_dec(te, a);
+            BIG_norm(te);
+            BIG_fshr(te, 2);
+            const int b = BIG_lastbits(tf, 3) - 4;
+            BIG_dec(tf, b);
+            BIG_norm(tf);
+            BIG_fshr(tf, 2);
+            w[i] = (signed char)(4 * a + b);
+        }
+        w[nb] = (signed char)(4 * BIG_lastbits(te, 3) + BIG_lastbits(tf, 3));
+
+        for(size_t p = 0; p < n; ++p)
+        {
+            T table[8], S, T2, C, D;
+            table[1] = r[p];
+            sub_from(&table[1], &q[p]);
+            table[2] = r[p];
+            add_to(&table[2], &q[p]);
+            S = q[p];
+            twice(&S);
+            table[0] = table[1];
+            sub_from(&table[0], &S);
+            table[3] = table[2];
+            add_to(&table[3], &S);
+            T2 = r[p];
+            twice(&T2);
+            table[5] = table[1];
+            add_to(&table[5], &T2);
+            table[6] = table[2];
+            add_to(&table[6], &T2);
+            table[4] = table[5];
+            sub_from(&table[4], &S);
+            table[7] = table[6];
+            add_to(&table[7], &S);
+
+            C = T2;
+            conditional_move(&C, &r[p], ns_e);
+            D = S;
+            conditional_move(&D, &q[p], ns_f);
+            add_to(&C, &D);
+
+            select(&r[p], table, w[nb]);
+            for(int i = nb - 1; i >= 0; --i)
+            {
+                select(&D, table, w[i]);
+                twice(&r[p]);
+                twice(&r[p]);
+                add_to(&r[p], &D);
+            }
+            sub_from(&r[p], &C);
+        }
+    }
+
+    // r[i] = Σ(u[j] * bases[4i + j]) for i in [n], j in [4] and u[j] < 2^n_bits, with the sign aligned digits of ECP2_mul4
+    // the digits are recoded once for all points, the time depends on n and n_bits only
+    template<typename T>
+    void aligned_window(T* r, size_t n, T* bases, const BIG u[4], int n_bits) noexcept
+    {
+        BIG t[4];
+        for(int j = 0; j < 4; ++j)
+        {
+            BIG_copy(t[j], u[j]);
+            BIG_norm(t[j]);
+        }
+
+        // the pivot t[0] is made odd, bases[4i] is taken back for even u[0]
+        const int pb = 1 - BIG_parity(t[0]);
+        BIG_inc(t[0], pb);
+        BIG_norm(t[0]);
+
+        signed char s[max_wnaf_digits], w[max_wnaf_digits];
+        const int nb = 1 + n_bits;
+        s[nb - 1] = 1;
+        for(int i = 0; i < nb - 1; ++i)
+        {
+            BIG_fshr(t[0], 1);
+            s[i] = (signed char)(2 * BIG_parity(t[0]) - 1);
+        }
+        for(int i = 0; i < nb; ++i)
+        {
+            int digit = 0;
+            for(int j = 1, k = 1; j < 4; ++j, k *= 2)
+            {
+                const int bt = s[i] * BIG_parity(t[j]);
+                BIG_fshr(t[j], 1);
+                BIG_dec(t[j], bt >> 1);
+                BIG_norm(t[j]);
+                digit += bt * k;
+            }
+            w[i] = (signed char)digit;
+        }
+
+        for(size_t p = 0; p < n; ++p)
+        {
+            T* Q = &bases[4 * p];
+            T table[8], W;
+            table[0] = Q[0];
+            table[1] = table[0];
+            add_to(&table[1], &Q[1]);
+            table[2] = table[0];
+            add_to(&table[2], &Q[2]);
+            table[3] = table[1];
+            add_to(&table[3], &Q[2]);
+            for(int i = 0; i < 4; ++i)
+            {
+                table[4 + i] = table[i];
+                add_to(&table[4 + i], &Q[3]);
+            }
+
+            select(&r[p], table, 2 * w[nb - 1] + 1);
+            for(int i = nb - 2; i >= 0; --i)
+            {
+                select(&W, table, 2 * w[i] + s[i]);
+                twice(&r[p]);
+                add_to(&r[p], &W);
+            }
+            W = r[p];
+            sub_from(&W, &Q[0]);
+            conditional_move(&r[p], &W, pb);
+        }
+    }
+
+    // r[i] = k * r[i] for i in [n], k < 2^n_bits and n_bits <= 128, with windows over k up to 64 bits
+    // and over k = u0 + u1 * |x| with the endomorphism of eigenvalue x above
+    template<typename T>
+    void windowed_multiply(T* r, size_t n, const BIG k, int n_bits, FP2* X) noexcept
+    {
+        if(n_bits <= 64)
+        {
+            fixed_window(r, n, k, n_bits);
+            return;
+        }
+
+        BIG x, u0, u1;
+        BIG_rcopy(x, CURVE_Bnx);
+        const int bd = n_bits - BIG_nbits(x);
+        BIG_copy(u0, k);
+        BIG_ctmod(u0, x, bd);
+        BIG_copy(u1, k);
+        BIG_ctsdiv(u1, x, bd);
+
+        scratch_vector<T> q(n, scratch_resource());
+        for(size_t p = 0; p < n; ++p)
+        {
+            T bases[2];
+            bases[0] = r[p];
+            gs_bases(bases, 2, X);
+            q[p] = bases[1];
+        }
+        joint_window(r, q.data(), n, u0, u1, std::max(BIG_nbits(x), bd + 1));
+    }
+
+    // w = k mod r for k < 2^255 in constant time
+    void reduce_constant(BIG w, const BIG k) noexcept
+    {
+        BIG r;
+        BIG_rcopy(r, CURVE_Order);
+        BIG_copy(w, k);
+        BIG_ctmod(w, r, 0);
+    }
+
+    // k = u[0] + x^2 * u[1] in constant time as glv_split, both halves less than 2^128
+    void glv_split_constant(BIG u[2], const BIG k) noexcept
+    {
+        BIG x, x2;
+        BIG_rcopy(x, CURVE_Bnx);
+        BIG_smul(x2, x, x);
+        const int bd = 255 - BIG_nbits(x2);
+        reduce_constant(u[0], k);
+        BIG_copy(u[1], u[0]);
+        BIG_ctmod(u[0], x2, bd);
+        BIG_ctsdiv(u[1], x2, bd);
+    }
+
+    // k = Σ(u[i] * |x|^i) for i in [4] in constant time as gs_split, all parts less than 2^64
+    void gs_split_constant(BIG u[4], const BIG k) noexcept
+    {
+        BIG x, w;
+        BIG_rcopy(x, CURVE_Bnx);
+        reduce_constant(w, k);
+        for(int i = 0, bd = 255 - BIG_nbits(x); i < 3; ++i, bd -= BIG_nbits(x))
+        {
+            BIG_copy(u[i], w);
+            BIG_ctmod(u[i], x, bd);
+            BIG_ctsdiv(w, x, bd);
+        }
+        BIG_copy(u[3], w);
+    }
+
+    // the costs of the group operations relative to a conditional move of a point
+    constexpr long add_cost = 44;
+    constexpr long double_cost = 26;
+
+    // the signed odd digits of k + 1 for even k and k + 2 for odd k in windows of c bits as ECP_clmul
+    // n_digits = (n_bits + c) / c digits in [1 - 2^c, 2^c - 1] and an implied 1 above them
+    // return 1 for odd k, without branching on k
+    int to_fixed_digits(signed char* digits, const BIG k, int n_bits, int c) noexcept
+    {
+        BIG t, mt;
+        BIG_copy(t, k);
+        BIG_norm(t);
+        const int s = BIG_parity(t);
+        BIG_inc(t, 1);
+        BIG_norm(t);
+        BIG_copy(mt, t);
+        BIG_inc(mt, 1);
+        BIG_norm(mt);
+        BIG_cmove(t, mt, s);
+
+        const int n_digits = (n_bits + c) / c;
+        for(int i = 0; i < n_digits; ++i)
+        {
+            digits[i] = (signed char)(BIG_lastbits(t, c + 1) - (1 << c));
+            BIG_dec(t, digits[i]);
+            BIG_norm(t);
+            BIG_fshr(t, c);
+        }
+        return s;
+    }
+
+    constexpr int max_fixed_window = 6;
+
+    // the cost of the buckets of window c for n numbers of n_bits bits, each addition scans all the buckets of its window
+    long fixed_bucket_cost(long n, int n_bits, int c) noexcept
+    {
+        const long n_windows = (n_bits + c) / c;
+        return n_windows * (n * (add_cost + (1L << c)) + (1L << c) * add_cost + c * double_cost)
+            + n * (add_cost + double_cost);
+    }
+
+    // the window of the least cost of the buckets for n numbers
+    int fixed_bucket_window(long n, int n_bits) noexcept
+    {
+        int best = 2;
+        for(int c = 3; c <= max_fixed_window; ++c)
+        {
+            if(fixed_bucket_cost(n, n_bits, c) < fixed_bucket_cost(n, n_bits, best))
+            {
+                best = c;
+            }
+        }
+        return best;
+    }
+}
+
+namespace
+{
+    // the field operations of the affine additions below, for the coordinates of ECP and ECP2
+    void field_add(FP* r, FP* a, FP* b) noexcept
+    {
+        FP_add(r, a, b);
+        FP_norm(r);
+    }
+
+    void field_add(FP2* r, FP2* a, FP2* b) noexcept
+    {
+        FP2_add(r, a, b);
+        FP2_norm(r);
+    }
+
+    void field_sub(FP* r, FP* a, FP* b) noexcept
+    {
+        FP_sub(r, a, b);
+        FP_norm(r);
+    }
+
+    void field_sub(FP2* r, FP2* a, FP2* b) noexcept
+    {
+        FP2_sub(r, a, b);
+        FP2_norm(r);
+    }
+
+    void field_mul(FP* r, FP* a, FP* b) noexcept
+    {
+        FP_mul(r, a, b);
+    }
+
+    void field_mul(FP2* r, FP2* a, FP2* b) noexcept
+    {
+        FP2_mul(r, a, b);
+    }
+
+    void field_sqr(FP* r, FP* a) noexcept
+    {
+        FP_sqr(r, a);
+    }
+
+    void field_sqr(FP2* r, FP2* a) noexcept
+    {
+        FP2_sqr(r, a);
+    }
+
+    void field_inv(FP* r, FP* a) noexcept
+    {
+        FP_inv(r, a, NULL);
+    }
+
+    void field_inv(FP2* r, FP2* a) noexcept
+    {
+        FP2_inv(r, a, NULL);
+    }
+
+    void field_one(FP* a) noexcept
+    {
+        FP_one(a);
+    }
+
+    void field_one(FP2* a) noexcept
+    {
+        FP2_one(a);
+    }
+
+    bool field_is_zero(FP* a) noexcept
+    {
+        return FP_iszilch(a);
+    }
+
+    bool field_is_zero(FP2* a) noexcept
+    {
+        return FP2_iszilch(a);
+    }
+
+    // the same limbs, without the reductions of FP_equals
+    bool same_representation(const FP* a, const FP* b) noexcept
+    {
+        using crypto12381::detail::miracl_core::fp;
+        return crypto12381::detail::miracl_core::same_representation(*(const fp*)a, *(const fp*)b);
+    }
+
+    bool same_representation(const FP2* a, const FP2* b) noexcept
+    {
+        using crypto12381::detail::miracl_core::fp2;
+        return crypto12381::detail::miracl_core::same_representation(*(const fp2*)a, *(const fp2*)b);
+    }
+
+    bool is_identity(ECP* P) noexcept
+    {
+        return ECP_isinf(P);
+    }
+
+    bool is_identity(ECP2* P) noexcept
+    {
+        return ECP2_isinf(P);
+    }
+
+    void make_affine(ECP* P) noexcept
+    {
+        ECP_affine(P);
+    }
+
+    void make_affine(ECP2* P) noexcept
+    {
+        ECP2_affine(P);
+    }
+
+    // a[i] = 1 / a[i] for i in [n] with a single inversion
+    // return false and leave a unchanged if some a[i] is zero
+    template<typename F>
+    bool batch_invert(F* a, size_t n, scratch_vector<F>& prefix) noexcept
+    {
+        if(n == 0)
+        {
+            return true;
+        }
+        prefix.resize(n);
+        prefix[0] = a[0];
+        for(size_t i = 1; i < n; ++i)
+        {
+            field_mul(&prefix[i], &prefix[i - 1], &a[i]);
+        }
+        if(field_is_zero(&prefix[n - 1]))
+        {
+            return false;
+        }
+        F inverse;
+        note(&EvaluationPlan::Zp_and_batch_inversions);
+        field_inv(&inverse, &prefix[n - 1]);
+        for(size_t i = n - 1; i > 0; --i)
+        {
+            F t;
+            field_mul(&t, &inverse, &prefix[i - 1]);
+            field_mul(&inverse, &inverse, &a[i]);
+            a[i] = t;
+        }
+        a[0] = inverse;
+        return true;
+    }
+
+    // the levels of tree_sum with fewer pairs than this add in projective coordinates, saving their inversions
+    constexpr size_t min_affine_pairs = 256;
+
+    // r = Σ(points[i]) for i in [n] by a balanced tree, each level of at least min_affine_pairs pairs
+    // adds in affine coordinates with a single inversion for all of its pairs
+    // the points must be affine mostly, e.g. parsed, since scaling the others costs more than the tree saves,
+    // otherwise they are added one after another in projective coordinates
+    // in variable time, the identities and the pairs of equal x take their own branches
+    template<typename T>
+    void tree_sum(T* r, size_t n, const T* points)
+    {
+        using F = decltype(T::x);
+        struct affine_point
+        {
+            F x;
+            F y;
+        };
+
+        auto projective = [](affine_point& p)
+        {
+            T P;
+            P.x = p.x;
+            P.y = p.y;
+            field_one(&P.z);
+            return P;
+        };
+
+        auto add_each = [&]()
+        {
+            set_identity(r);
+            for(size_t i = 0; i < n; ++i)
+            {
+                T P = points[i];
+                add_to(r, &P);
+            }
+        };
+
+        F one;
+        field_one(&one);
+        const size_t n_affine = std::count_if(points, points + n, [&](const T& P)
+        {
+            return same_representation(&P.z, &one);
+        });
+        if(n / 2 < min_affine_pairs || n_affine < n - n / 4)
+        {
+            add_each();
+            return;
+        }
+
+        scratch_vector<affine_point> level{ scratch_resource() };
+        scratch_vector<F> z{ scratch_resource() };
+        scratch_vector<size_t> scaled{ scratch_resource() };
+        level.reserve(n);
+        for(size_t i = 0; i < n; ++i)
+        {
+            T P = points[i];
+            if(is_identity(&P))
+            {
+                continue;
+            }
+            level.push_back(affine_point{ P.x, P.y });
+            if(not same_representation(&P.z, &one))
+            {
+                z.push_back(P.z);
+                scaled.push_back(level.size() - 1);
+            }
+        }
+
+        scratch_vector<F> prefix{ scratch_resource() };
+        batch_invert(z.data(), z.size(), prefix);
+        for(size_t k = 0; k < scaled.size(); ++k)
+        {
+            affine_point& p = level[scaled[k]];
+            field_mul(&p.x, &p.x, &z[k]);
+            field_mul(&p.y, &p.y, &z[k]);
+        }
+
+        scratch_vector<F> d{ scratch_resource() };
+        scratch_vector<char> equal_x{ scratch_resource() };
+        scratch_vector<affine_point> next{ scratch_resource() };
+        while(level.size() / 2 >= min_affine_pairs)
+        {
+            const size_t m = level.size() / 2;
+            d.resize(m);
+            equal_x.assign(m, 0);
+            for(size_t k = 0; k < m; ++k)
+            {
+                field_sub(&d[k], &level[2 * k + 1].x, &level[2 * k].x);
+            }
+            // the product of all differences is zero only if some pair has equal x, rarely
+            if(not batch_invert(d.data(), m, prefix))
+            {
+                for(size_t k = 0; k < m; ++k)
+                {
+                    field_sub(&d[k], &level[2 * k + 1].x, &level[2 * k].x);
+                    if(field_is_zero(&d[k]))
+                    {
+                        equal_x[k] = 1;
+                        field_one(&d[k]);
+                    }
+                }
+                batch_invert(d.data(), m, prefix);
+            }
+
+            next.clear();
+            for(size_t k = 0; k < m; ++k)
+            {
+                affine_point& p = level[2 * k];
+                affine_point& q = level[2 * k + 1];
+                if(equal_x[k])
+                {
+                    // q = p or q = -p
+                    T P = projective(p);
+                    T Q = projective(q);
+                    add_to(&P, &Q);
+                    if(not is_identity(&P))
+                    {
+                        make_affine(&P);
+                        next.push_back(affine_point{ P.x, P.y });
+                    }
+                    continue;
+                }
+
+                // lambda = (q.y - p.y) / (q.x - p.x), x = lambda^2 - p.x - q.x, y = lambda * (p.x - x) - p.y
+                F lambda, t;
+                affine_point s;
+                field_sub(&lambda, &q.y, &p.y);
+                field_mul(&lambda, &lambda, &d[k]);
+                field_sqr(&s.x, &lambda);
+                field_add(&t, &p.x, &q.x);
+                field_sub(&s.x, &s.x, &t);
+                field_sub(&t, &p.x, &s.x);
+                field_mul(&s.y, &lambda, &t);
+                field_sub(&s.y, &s.y, &p.y);
+                next.push_back(s);
+            }
+            if(level.size() % 2 == 1)
+            {
+                next.push_back(level.back());
+            }
+            std::swap(level, next);
+        }
+
+        set_identity(r);
+        for(affine_point& p : level)
+        {
+            T P = projective(p);
+            add_to(r, &P);
+        }
+    }
+}
+
 namespace crypto12381::detail::miracl_core
 {
     int from_bytes(point1& result, bytes_view& bytes) noexcept
     {
+        note(&EvaluationPlan::parses);
         return ECP_fromOctet((ECP*)&result, (octet*)&bytes);
     }
 
+    int decompress(point1& result, const char* bytes) noexcept
+    {
+        note(&EvaluationPlan::parses);
+        auto point = (ECP*)&result;
+        BIG x;
+        BIG_fromBytes(x, (char*)bytes + 1);
+        FP_nres(&(point->x), x);
+
+        FP rhs, hint;
+        ECP_rhs(&rhs, &(point->x));
+        if(!is_square(&rhs, &hint))
+        {
+            ECP_inf(point);
+            return 0;
+        }
+
+        FP_sqrt(&(point->y), &rhs, &hint);
+        if(FP_sign(&(point->y)) != (bytes[0] & 1))
+        {
+            FP_neg(&(point->y), &(point->y));
+        }
+        FP_reduce(&(point->y));
+        FP_one(&(point->z));
+        return 1;
+    }
+
+    // sigma(P) = -x^2 * P, https://eprint.iacr.org/2021/1130
+    bool is_in_subgroup(point1& point) noexcept
+    {
+        note(&EvaluationPlan::subgroup_checks);
+        auto P = (ECP*)&point;
+        if(ECP_isinf(P))
+        {
+            return true;
+        }
+
+        ECP W, T;
+        ECP_copy(&T, P);
+        multiply_by_curve_parameter(&T);
+        if(ECP_equals(P, &T))
+        {
+            return false;
+        }
+        multiply_by_curve_parameter(&T);
+        ECP_neg(&T);
+
+        FP cru;
+        FP_rcopy(&cru, CRu);
+        ECP_copy(&W, P);
+        FP_mul(&(W.x), &(W.x), &cru);
+        return ECP_equals(&W, &T) == 1;
+    }
+
     void to_bytes(bytes_view& result, point1& point, bool compressed) noexcept
     {
         ECP_toOctet((octet*)&result, (ECP*)&point, compressed);
     }
 
+    void affine_x_to_bytes(char* result, const point1& point) noexcept
+    {
+        FP x = ((const ECP*)&point)->x;
+        BIG value;
+        FP_redc(value, &x);
+        BIG_toBytes(result, value);
+    }
+
     bool is_infinity(const point1& point) noexcept
     {
         return ECP_isinf((const ECP*)&point) == 1;
@@ -126,22 +1659,199 @@ namespace crypto12381::detail::miracl_core
         ECP_neg((ECP*)&point);
     }
 
-    void add(point1& object, point1& point) noexcept
+    void add(point1& object, const point1& point) noexcept
     {
         ECP_add((ECP*)&object, (ECP*)&point);
     }
 
-    void sum_of_products(point1& result, int n, point1* points, const big* numbers) noexcept
+    void sum(point1& result, size_t n, const point1* points)
+    {
+        note(&EvaluationPlan::point_sums);
+        tree_sum((ECP*)&result, n, (const ECP*)points);
+    }
+
+    namespace
+    {
+        // object = value * object in constant time for value < 2^n_bits
+        void clmul_bounded(point1& object, const big& value, int n_bits) noexcept
+        {
+            BIG e, maxe;
+            BIG_copy(e, value);
+            power_of_two(maxe, n_bits);
+            BIG_dec(maxe, 1);
+            BIG_norm(maxe);
+            ECP_clmul((ECP*)&object, e, maxe);
+        }
+
+        // p1 = v1 * p1 + v2 * p2 in constant time for v1, v2 < 2^n_bits
+        void clmul2_bounded(point1& p1, point1& p2, const big& v1, const big& v2, int n_bits) noexcept
+        {
+            BIG e, f, maxe;
+            BIG_copy(e, v1);
+            BIG_copy(f, v2);
+            power_of_two(maxe, n_bits);
+            BIG_dec(maxe, 1);
+            BIG_norm(maxe);
+            ECP_clmul2((ECP*)&p1, (ECP*)&p2, e, f, maxe);
+        }
+    }
+
+    void sum_of_products(point1& result, size_t n, const point1* points, const big* numbers, int n_bits)
+    {
+        const long pairs_cost = ((long)n + 1) / 2 * ((n_bits + 1) / 2) * (2 * double_cost + add_cost + 8);
+        if(pairs_cost <= fixed_bucket_cost((long)n, n_bits, fixed_bucket_window((long)n, n_bits)))
+        {
+            note(&EvaluationPlan::multi_scalar_multiplications);
+            note(&EvaluationPlan::msm_points, n);
+            get_infinity(result);
+            for(size_t i = 0; i + 1 < n; i += 2)
+            {
+                point1 p1 = points[i];
+                point1 p2 = points[i + 1];
+                clmul2_bounded(p1, p2, numbers[i], numbers[i + 1], n_bits);
+                add(result, p1);
+            }
+            if(n % 2 == 1)
+            {
+                point1 p = points[n - 1];
+                if(n_bits <= 128)
+                {
+                    clmul_bounded(p, numbers[n - 1], n_bits);
+                }
+                else
+                {
+                    PAIR_G1mul((ECP*)&p, numbers[n - 1]);
+                }
+                add(result, p);
+            }
+            return;
+        }
+
+        product_buckets buckets{ n, n_bits, scratch_resource() };
+        buckets.add(n, points, numbers);
+        buckets.finish(result);
+    }
+
+    product_buckets::product_buckets(size_t n, int n_bits, std::pmr::memory_resource* resource)
+    : n_bits_{ n_bits }, window_{ fixed_bucket_window((long)std::max(n, 1uz), n_bits) }, 
+      n_windows_{ (n_bits + window_) / window_ }, n_buckets_{ 1 << (window_ - 1) },
+      buckets_((size_t)(n_windows_ * n_buckets_), resource)
+    {
+        for(auto& bucket : buckets_)
+        {
+            ECP_inf((ECP*)&bucket);
+        }
+        ECP_inf((ECP*)&top_);
+        ECP_inf((ECP*)&correction_);
+    }
+
+    void product_buckets::add(size_t n, const point1* points, const big* numbers) noexcept
+    {
+        note(&EvaluationPlan::msm_points, n);
+        for(size_t i = 0; i < n; ++i)
+        {
+            signed char digits[max_wnaf_digits];
+            const int odd = to_fixed_digits(digits, numbers[i], n_bits_, window_);
+
+            ECP S, N, B;
+            const ECP& P = *(const ECP*)&points[i];
+            N = P;
+            ECP_neg(&N);
+            for(int j = 0; j < n_windows_; ++j)
+            {
+                const int m = digits[j] >> 7;
+                const int index = (((digits[j] ^ m) - m) - 1) / 2;
+                ECP* window = (ECP*)&buckets_[(size_t)(j * n_buckets_)];
+                for(int b = 0; b < n_buckets_; ++b)
+                {
+                    conditional_move(&B, &window[b], is_equal(index, b));
+                }
+                S = P;
+                conditional_move(&S, &N, m & 1);
+                ECP_add(&B, &S);
+                for(int b = 0; b < n_buckets_; ++b)
+                {
+                    conditional_move(&window[b], &B, is_equal(index, b));
+                }
+            }
+            S = P;
+            ECP_add((ECP*)&top_, &S);
+
+            // take back the P or 2 * P added to make the number odd
+            B = P;
+            ECP_dbl(&S);
+            conditional_move(&S, &B, 1 - odd);
+            ECP_add((ECP*)&correction_, &S);
+        }
+    }
+
+    void product_buckets::add_vartime(size_t n, const point1* points, const big* numbers) noexcept
+    {
+        note(&EvaluationPlan::msm_points, n);
+        for(size_t i = 0; i < n; ++i)
+        {
+            signed char digits[max_wnaf_digits];
+            const int odd = to_fixed_digits(digits, numbers[i], n_bits_, window_);
+
+            ECP S = *(const ECP*)&points[i];
+            for(int j = 0; j < n_windows_; ++j)
+            {
+                ECP& bucket = *(ECP*)&buckets_[(size_t)(j * n_buckets_ + (std::abs(digits[j]) - 1) / 2)];
+                if(digits[j] > 0)
+                {
+                    ECP_add(&bucket, &S);
+                }
+                else
+                {
+                    ECP_sub(&bucket, &S);
+                }
+            }
+            ECP_add((ECP*)&top_, &S);
+            if(odd == 1)
+            {
+                ECP_dbl(&S);
+            }
+            ECP_add((ECP*)&correction_, &S);
+        }
+    }
+
+    void product_buckets::finish(point1& result) const noexcept
     {
-        ECP_muln((ECP*)&result, n, (ECP*)points, numbers);
+        note(&EvaluationPlan::multi_scalar_multiplications);
+        ECP* r = (ECP*)&result;
+        ECP_copy(r, (ECP*)&top_);
+        for(int j = n_windows_ - 1; j >= 0; --j)
+        {
+            for(int i = 0; i < window_; ++i)
+            {
+                ECP_dbl(r);
+            }
+
+            // Σ((2b + 1) * B[b]) = 2 * Σ((b + 1) * B[b]) - Σ(B[b]) by running sums
+            ECP running, sum, bucket;
+            ECP_inf(&running);
+            ECP_inf(&sum);
+            for(int b = n_buckets_ - 1; b >= 0; --b)
+            {
+                ECP_copy(&bucket, (ECP*)&buckets_[(size_t)(j * n_buckets_ + b)]);
+                ECP_add(&running, &bucket);
+                ECP_add(&sum, &running);
+            }
+            ECP_dbl(&sum);
+            ECP_sub(&sum, &running);
+            ECP_add(r, &sum);
+        }
+        ECP correction;
+        ECP_copy(&correction, (ECP*)&correction_);
+        ECP_sub(r, &correction);
     }
 
-    void sub(point1& object, point1& point) noexcept
+    void sub(point1& object, const point1& point) noexcept
     {
         ECP_sub((ECP*)&object, (ECP*)&point);
     }
 
-    int equal(point1& l, point1& r) noexcept
+    int equal(const point1& l, const point1& r) noexcept
     {
         return ECP_equals((ECP*)&l, (ECP*)&r);
     }
@@ -153,6 +1863,7 @@ namespace crypto12381::detail::miracl_core
 
     void map_to_point(point1& result, const fp& value) noexcept
     {
+        note(&EvaluationPlan::hashes_to_curve);
         ECP_map2point((ECP*)&result, (const FP*)&value);
     }
 
@@ -161,6 +1872,22 @@ namespace crypto12381::detail::miracl_core
         ECP_cfp((ECP*)&object);
     }    
 
+    void map_to_points(point1* results, size_t n, const fp* values) noexcept
+    {
+        note(&EvaluationPlan::hashes_to_curve, n);
+        isogeny_constants constants;
+        for(size_t i = 0; i < n; ++i)
+        {
+            ECP* P = (ECP*)&results[i];
+            map_to_curve(P, (const FP*)&values[i], constants);
+
+            // the cofactor of ECP_cfp is 1 + |x|
+            ECP Q = *P;
+            multiply_by_curve_parameter(&Q);
+            ECP_add(P, &Q);
+        }
+    }
+
     void get_infinity(point1& result) noexcept
     {
         ECP_inf((ECP*)&result);
@@ -173,27 +1900,178 @@ namespace crypto12381::detail::miracl_core
 
     void multiply(point1& object, const big& value) noexcept
     {
+        note(&EvaluationPlan::multiplications);
         PAIR_G1mul((ECP*)&object, value);
     }
 
     void double_multiply(point1& p1, point1& p2, big& v1, big& v2) noexcept
     {
+        note(&EvaluationPlan::double_multiplications);
         ECP_mul2((ECP*)&p1, (ECP*)&p2, v1, v2);
     }
+
+    void multiply(point1* objects, size_t n, const big& value) noexcept
+    {
+        note(&EvaluationPlan::multiplications, n);
+        BIG u[2];
+        glv_split_constant(u, value);
+        scratch_vector<ECP> q(n, scratch_resource());
+        for(size_t i = 0; i < n; ++i)
+        {
+            ECP bases[2];
+            glv_bases(bases, (const ECP*)&objects[i]);
+            q[i] = bases[1];
+        }
+        joint_window((ECP*)objects, q.data(), n, u[0], u[1], 128);
+    }
+
+    void multiply_bounded(point1* objects, size_t n, const big& value, int n_bits) noexcept
+    {
+        note(&EvaluationPlan::multiplications, n);
+        fixed_window((ECP*)objects, n, value, n_bits);
+    }
+
+    void multiply_bounded(point1& object, const big& value, int n_bits) noexcept
+    {
+        note(&EvaluationPlan::multiplications);
+        clmul_bounded(object, value, n_bits);
+    }
+
+    void double_multiply_bounded(point1& p1, point1& p2, const big& v1, const big& v2, int n_bits) noexcept
+    {
+        note(&EvaluationPlan::double_multiplications);
+        clmul2_bounded(p1, p2, v1, v2, n_bits);
+    }
+
+    void multiply_vartime(point1& object, const big& value) noexcept
+    {
+        note(&EvaluationPlan::multiplications);
+        ECP bases[2];
+        BIG u[2];
+        glv_bases(bases, (ECP*)&object);
+        glv_split(u, value);
+        interleaved_wnaf((ECP*)&object, 2, bases, u);
+    }
+
+    namespace
+    {
+        // result = Σ(numbers[i] * points[i]) in variable time, counted by the callers
+        void glv_sum_of_products(point1& result, size_t n, const point1* points, const big* numbers)
+        {
+            // the halves of glv_split have at most 128 bits, twice the points in half the windows
+            const int n_bases = (int)(2 * n);
+            scratch_vector<ECP> bases(n_bases, scratch_resource());
+            scratch_vector<chunk_t> k_limbs(n_bases * n_chunks, scratch_resource());
+            auto k = (BIG*)k_limbs.data();
+            int n_bits = 0;
+            for(size_t i = 0; i < n; ++i)
+            {
+                glv_bases(&bases[2 * i], (const ECP*)&points[i]);
+                glv_split(&k[2 * i], numbers[i]);
+                n_bits = std::max({ n_bits, BIG_nbits(k[2 * i]), BIG_nbits(k[2 * i + 1]) });
+            }
+
+            const auto [window, bucket_cost] = bucket_window(n_bases, n_bits);
+            if(bucket_cost < n_bases * wnaf_window(n_bits).second)
+            {
+                bucket_method((ECP*)&result, n_bases, bases.data(), k, n_bits, window);
+            }
+            else
+            {
+                interleaved_wnaf((ECP*)&result, n_bases, bases.data(), k);
+            }
+        }
+    }
+
+    void double_multiply_vartime(point1& p1, point1& p2, const big& v1, const big& v2) noexcept
+    {
+        note(&EvaluationPlan::double_multiplications);
+        const point1 points[]{ p1, p2 };
+        big numbers[2];
+        BIG_copy(numbers[0], v1);
+        BIG_copy(numbers[1], v2);
+        glv_sum_of_products(p1, 2, points, numbers);
+    }
+
+    void sum_of_products_vartime(point1& result, size_t n, const point1* points, const big* numbers)
+    {
+        note(&EvaluationPlan::multi_scalar_multiplications);
+        note(&EvaluationPlan::msm_points, n);
+        glv_sum_of_products(result, n, points, numbers);
+    }
 }
 
 namespace crypto12381::detail::miracl_core 
 {
     int from_bytes(point2& result, bytes_view& bytes) noexcept
     {
+        note(&EvaluationPlan::parses);
         return ECP2_fromOctet((ECP2*)&result, (octet*)&bytes);
     }
 
+    int decompress(point2& result, const char* bytes) noexcept
+    {
+        note(&EvaluationPlan::parses);
+        auto point = (ECP2*)&result;
+        FP2_fromBytes(&(point->x), (char*)bytes + 1);
+
+        // y^2 is a square iff its norm is a square in Fp
+        FP2 rhs, norm;
+        FP hint;
+        ECP2_rhs(&rhs, &(point->x));
+        FP2_conj(&norm, &rhs);
+        FP2_mul(&norm, &norm, &rhs);
+        if(!is_square(&(norm.a), &hint))
+        {
+            ECP2_inf(point);
+            return 0;
+        }
+
+        fp2_sqrt(&(point->y), &rhs, &(norm.a), &hint);
+        if(FP2_sign(&(point->y)) != (bytes[0] & 1))
+        {
+            FP2_neg(&(point->y), &(point->y));
+        }
+        FP2_reduce(&(point->y));
+        FP2_one(&(point->z));
+        return 1;
+    }
+
+    // psi(P) = x * P, https://eprint.iacr.org/2021/1130
+    bool is_in_subgroup(point2& point) noexcept
+    {
+        note(&EvaluationPlan::subgroup_checks);
+        auto P = (ECP2*)&point;
+        if(ECP2_isinf(P))
+        {
+            return true;
+        }
+
+        FP2 X;
+        psi_constant(&X);
+
+        ECP2 W, T;
+        ECP2_copy(&T, P);
+        multiply_by_curve_parameter(&T);
+#if SIGN_OF_X_BLS12381 == NEGATIVEX
+        ECP2_neg(&T);
+#endif
+        ECP2_copy(&W, P);
+        ECP2_frob(&W, &X);
+        return ECP2_equals(&W, &T) == 1;
+    }
+
     void to_bytes(bytes_view& result, point2& point, bool compressed) noexcept
     {
         ECP2_toOctet((octet*)&result, (ECP2*)&point, compressed);
     }
 
+    void affine_x_to_bytes(char* result, const point2& point) noexcept
+    {
+        FP2 x = ((const ECP2*)&point)->x;
+        FP2_toBytes(result, &x);
+    }
+
     bool is_infinity(const point2& point) noexcept
     {
         return ECP2_isinf((const ECP2*)&point) == 1;
@@ -201,25 +2079,75 @@ namespace crypto12381::detail::miracl_core
 
     void multiply(point2& object, const big& value) noexcept
     {
+        note(&EvaluationPlan::multiplications);
         PAIR_G2mul((ECP2*)&object, value);
     }
 
+    void multiply(point2* objects, size_t n, const big& value) noexcept
+    {
+        note(&EvaluationPlan::multiplications, n);
+        FP2 X;
+        psi_constant(&X);
+        BIG u[4];
+        gs_split_constant(u, value);
+        scratch_vector<ECP2> bases(4 * n, scratch_resource());
+        for(size_t i = 0; i < n; ++i)
+        {
+            bases[4 * i] = *(const ECP2*)&objects[i];
+            gs_bases(&bases[4 * i], 4, &X);
+        }
+        aligned_window((ECP2*)objects, n, bases.data(), u, 64);
+    }
+
+    void multiply_bounded(point2& object, const big& value, int n_bits) noexcept
+    {
+        multiply_bounded(&object, 1, value, n_bits);
+    }
+
+    void multiply_bounded(point2* objects, size_t n, const big& value, int n_bits) noexcept
+    {
+        note(&EvaluationPlan::multiplications, n);
+        FP2 X;
+        psi_constant(&X);
+        windowed_multiply((ECP2*)objects, n, value, n_bits, &X);
+    }
+
+    void multiply_vartime(point2& object, const big& value) noexcept
+    {
+        note(&EvaluationPlan::multiplications);
+        FP2 X;
+        psi_constant(&X);
+        ECP2 bases[4];
+        ECP2_copy(&bases[0], (ECP2*)&object);
+        gs_bases(bases, 4, &X);
+
+        BIG u[4];
+        gs_split(u, value);
+        interleaved_wnaf((ECP2*)&object, 4, bases, u);
+    }
+
     void negate(point2& point) noexcept
     {
         ECP2_neg((ECP2*)&point);
     }
 
-    void add(point2& object, point2& point) noexcept
+    void add(point2& object, const point2& point) noexcept
     {
         ECP2_add((ECP2*)&object, (ECP2*)&point);
     }
 
-    void sub(point2& object, point2& point) noexcept
+    void sum(point2& result, size_t n, const point2* points)
+    {
+        note(&EvaluationPlan::point_sums);
+        tree_sum((ECP2*)&result, n, (const ECP2*)points);
+    }
+
+    void sub(point2& object, const point2& point) noexcept
     {
         ECP2_sub((ECP2*)&object, (ECP2*)&point);
     }
 
-    int equal(point2& l, point2& r) noexcept
+    int equal(const point2& l, const point2& r) noexcept
     {
         return ECP2_equals((ECP2*)&l, (ECP2*)&r);
     }
@@ -234,12 +2162,28 @@ namespace crypto12381::detail::miracl_core
     {
         return ECP2_generator((ECP2*)&result);
     }
+
+    void map_to_points(point2* results, size_t n, const fp2* values) noexcept
+    {
+        note(&EvaluationPlan::hashes_to_curve, n);
+        FP2 X;
+        get_cofactor_frobenius(&X);
+        for(size_t i = 0; i < n; ++i)
+        {
+            ECP2* Q = (ECP2*)&results[i];
+            FP2 H;
+            FP2_copy(&H, (FP2*)&values[i]);
+            ECP2_map2point(Q, &H);
+            clear_cofactor(Q, &X);
+        }
+    }
 }
 
 namespace crypto12381::detail::miracl_core 
 {
     void from_bytes(fp12& result, bytes_view& bytes) noexcept
     {
+        note(&EvaluationPlan::parses);
         FP12_fromOctet((FP12*)&result, (octet*)&bytes);
     }
 
@@ -260,7 +2204,34 @@ namespace crypto12381::detail::miracl_core
 
     void pow(fp12& result, fp12& base, const big& exponent) noexcept
     {
-        FP12_pow((FP12*)&result, (FP12*)&base, exponent);
+        note(&EvaluationPlan::multiplications);
+        BIG e;
+        BIG_copy(e, exponent);
+        FP12_copy((FP12*)&result, (FP12*)&base);
+        PAIR_GTpow((FP12*)&result, e);
+    }
+
+    void pow_bounded(fp12& result, fp12& base, const big& exponent, int n_bits) noexcept
+    {
+        note(&EvaluationPlan::multiplications);
+        FP2 X;
+        frobenius_constant(&X);
+        FP12_copy((FP12*)&result, (FP12*)&base);
+        windowed_multiply((FP12*)&result, 1, exponent, n_bits, &X);
+    }
+
+    void pow_vartime(fp12& result, fp12& base, const big& exponent) noexcept
+    {
+        note(&EvaluationPlan::multiplications);
+        FP2 X;
+        frobenius_constant(&X);
+        FP12 bases[4];
+        FP12_copy(&bases[0], (FP12*)&base);
+        gs_bases(bases, 4, &X);
+
+        BIG u[4];
+        gs_split(u, exponent);
+        interleaved_wnaf((FP12*)&result, 4, bases, u);
     }
 
     int equal(fp12& l, fp12& r) noexcept
@@ -273,18 +2244,28 @@ namespace crypto12381::detail::miracl_core
         return FP12_isunity((FP12*)&value) == 1;
     }
 
-    void pair_ate(fp12& result, point2& p2, point1& p1) noexcept
+    bool is_in_subgroup(fp12& value) noexcept
+    {
+        note(&EvaluationPlan::subgroup_checks);
+        // PAIR_GTmember rejects the unity, which is the identity of GT
+        return FP12_isunity((FP12*)&value) == 1 || PAIR_GTmember((FP12*)&value) == 1;
+    }
+
+    void pair_ate(fp12& result, const point2& p2, const point1& p1) noexcept
     {
+        note(&EvaluationPlan::miller_loops);
         PAIR_ate((FP12*)&result, (ECP2*)&p2, (ECP*)&p1);
     }
 
     void pair_final_exponentiation(fp12& object) noexcept
     {
+        note(&EvaluationPlan::final_exponentiations);
         PAIR_fexp((FP12*)&object);
     }
 
-    void pair_double_ate(fp12& result, point2& p2, point1& p1, point2& q2, point1& q1) noexcept
+    void pair_double_ate(fp12& result, const point2& p2, const point1& p1, const point2& q2, const point1& q1) noexcept
     {
+        note(&EvaluationPlan::miller_loops, 2);
         PAIR_double_ate((FP12*)&result, (ECP2*)&p2, (ECP*)&p1, (ECP2*)&q2, (ECP*)&q1);
     }
 }
@@ -1,32 +1,268 @@
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <span>
 #include <string>
+#include <utility>
 #include <miracl-core/randapi.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define CRYPTO12381_AES_X86
+#endif
+
 #include <crypto12381/random.hpp>
+#include <crypto12381/hash_function.hpp>
 
 namespace crypto12381
 {
-    struct RandomEngine::Impl : core::csprng
+    namespace
     {
+        struct aes_ctr_state
+        {
+            char key[32];
+            std::uint64_t counter;
+        };
+
+        // the counter block is 8 zero bytes followed by the big-endian counter
+        void set_counter_block(unsigned char (&block)[16], std::uint64_t counter) noexcept
+        {
+            std::memset(block, 0, 8);
+            for(size_t i = 0; i < 8; ++i)
+            {
+                block[15 - i] = (unsigned char)(counter >> (8 * i));
+            }
+        }
+
+        void aes_ctr_portable(aes_ctr_state& state, unsigned char* out, size_t n_blocks) noexcept
+        {
+            core::aes aes;
+            core::AES_init(&aes, ECB, 32, state.key, nullptr);
+            for(size_t i = 0; i < n_blocks; ++i)
+            {
+                unsigned char block[16];
+                set_counter_block(block, state.counter++);
+                core::AES_ecb_encrypt(&aes, block);
+                std::memcpy(out + 16 * i, block, 16);
+            }
+            core::AES_end(&aes);
+        }
+
+#ifdef CRYPTO12381_AES_X86
+        template<int Rcon>
+        __attribute__((target("aes")))
+        __m128i expand_even(__m128i prev2, __m128i prev1) noexcept
+        {
+            const __m128i t = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(prev1, Rcon), 0xff);
+            prev2 = _mm_xor_si128(prev2, _mm_slli_si128(prev2, 4));
+            prev2 = _mm_xor_si128(prev2, _mm_slli_si128(prev2, 4));
+            prev2 = _mm_xor_si128(prev2, _mm_slli_si128(prev2, 4));
+            return _mm_xor_si128(prev2, t);
+        }
+
+        __attribute__((target("aes")))
+        __m128i expand_odd(__m128i prev2, __m128i prev1) noexcept
+        {
+            const __m128i t = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(prev1, 0), 0xaa);
+            prev2 = _mm_xor_si128(prev2, _mm_slli_si128(prev2, 4));
+            prev2 = _mm_xor_si128(prev2, _mm_slli_si128(prev2, 4));
+            prev2 = _mm_xor_si128(prev2, _mm_slli_si128(prev2, 4));
+            return _mm_xor_si128(prev2, t);
+        }
+
+        __attribute__((target("aes")))
+        void aes_ctr_ni(aes_ctr_state& state, unsigned char* out, size_t n_blocks) noexcept
+        {
+            __m128i k[15];
+            k[0] = _mm_loadu_si128((const __m128i*)state.key);
+            k[1] = _mm_loadu_si128((const __m128i*)(state.key + 16));
+            k[2] = expand_even<0x01>(k[0], k[1]);
+            k[3] = expand_odd(k[1], k[2]);
+            k[4] = expand_even<0x02>(k[2], k[3]);
+            k[5] = expand_odd(k[3], k[4]);
+            k[6] = expand_even<0x04>(k[4], k[5]);
+            k[7] = expand_odd(k[5], k[6]);
+            k[8] = expand_even<0x08>(k[6], k[7]);
+            k[9] = expand_odd(k[7], k[8]);
+            k[10] = expand_even<0x10>(k[8], k[9]);
+            k[11] = expand_odd(k[9], k[10]);
+            k[12] = expand_even<0x20>(k[10], k[11]);
+            k[13] = expand_odd(k[11], k[12]);
+            k[14] = expand_even<0x40>(k[12], k[13]);
+
+            auto counter_block = [&]()
+            {
+                // the big-endian counter lands in the high half
+                return _mm_set_epi64x((long long)std::byteswap(state.counter++), 0);
+            };
+
+            // four independent blocks keep the aes units busy
+            constexpr size_t lanes = 4;
+            size_t i = 0;
+            for(; i + lanes <= n_blocks; i += lanes)
+            {
+                __m128i b[lanes];
+                for(auto& e : b)
+                {
+                    e = _mm_xor_si128(counter_block(), k[0]);
+                }
+                for(int r = 1; r < 14; ++r)
+                {
+                    for(auto& e : b)
+                    {
+                        e = _mm_aesenc_si128(e, k[r]);
+                    }
+                }
+                for(size_t j = 0; j < lanes; ++j)
+                {
+                    _mm_storeu_si128((__m128i*)(out + 16 * (i + j)), _mm_aesenclast_si128(b[j], k[14]));
+                }
+            }
+            for(; i < n_blocks; ++i)
+            {
+                __m128i b = _mm_xor_si128(counter_block(), k[0]);
+                for(int r = 1; r < 14; ++r)
+                {
+                    b = _mm_aesenc_si128(b, k[r]);
+                }
+                _mm_storeu_si128((__m128i*)(out + 16 * i), _mm_aesenclast_si128(b, k[14]));
+            }
+        }
 
+        bool cpu_has_aes_ni() noexcept
+        {
+            unsigned int eax, ebx, ecx, edx;
+            return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES);
+        }
+#endif
+
+        using aes_ctr_t = void(*)(aes_ctr_state&, unsigned char*, size_t) noexcept;
+
+        // selected on the first use, so engines created during the static initialization of another translation unit work
+        aes_ctr_t selected_aes_ctr() noexcept
+        {
+            static const aes_ctr_t aes_ctr = []() -> aes_ctr_t
+            {
+#ifdef CRYPTO12381_AES_X86
+                if(cpu_has_aes_ni())
+                {
+                    return aes_ctr_ni;
+                }
+#endif
+                return aes_ctr_portable;
+            }();
+            return aes_ctr;
+        }
+
+        void aes_ctr(aes_ctr_state& state, unsigned char* out, size_t n_blocks) noexcept
+        {
+            selected_aes_ctr()(state, out, n_blocks);
+        }
+    }
+
+    struct RandomEngine::Impl : core::csprng
+    {
+        random_backend backend;
+        aes_ctr_state aes;
     };
 
-    RandomEngine::RandomEngine(std::span<const char> seed)
+    RandomEngine::RandomEngine(std::span<const char> seed, random_backend backend)
     {
-        core::csprng* rng = impl_ = new RandomEngine::Impl;
+        impl_ = new RandomEngine::Impl;
+        impl_->backend = backend;
+        if(backend == random_backend::aes_ctr)
+        {
+            detail::sha256_state state;
+            detail::sha256_init(state);
+            detail::sha256_process(state, seed);
+            detail::sha256_hash(state, impl_->aes.key);
+            impl_->aes.counter = 0;
+            return;
+        }
+
+        core::csprng* rng = impl_;
         std::string buffer{ seed.begin(), seed.end() };
         core::octet buffer_view{
-            .len = (int)buffer.size(), 
-            .max = (int)buffer.size(), 
+            .len = (int)buffer.size(),
+            .max = (int)buffer.size(),
             .val = buffer.data()
         };
         core::CREATE_CSPRNG(rng, &buffer_view);
     }
 
+    RandomEngine::RandomEngine(RandomEngine&& other) noexcept
+    : impl_{ std::exchange(other.impl_, nullptr) }
+    {
+
+    }
+
     RandomEngine::~RandomEngine() noexcept
     {
+        if(impl_ == nullptr)
+        {
+            return;
+        }
         core::csprng* rng = impl_;
         core::KILL_CSPRNG(rng);
+        std::memset(&impl_->aes, 0, sizeof(impl_->aes));
         delete impl_;
     }
+
+    random_backend RandomEngine::backend() const noexcept
+    {
+        assert(impl_ != nullptr && "a moved-from RandomEngine has no state");
+        return impl_->backend;
+    }
+
+    void RandomEngine::fill(std::span<char> bytes) noexcept
+    {
+        assert(impl_ != nullptr && "a moved-from RandomEngine has no state");
+        if(impl_->backend == random_backend::csprng)
+        {
+            for(auto& byte : bytes)
+            {
+                byte = core::RAND_byte(impl_);
+            }
+            return;
+        }
+
+        auto out = (unsigned char*)bytes.data();
+        const size_t n_blocks = bytes.size() / 16;
+        aes_ctr(impl_->aes, out, n_blocks);
+
+        // the tail and the next key, which keeps earlier outputs safe if the state leaks
+        unsigned char rest[48];
+        aes_ctr(impl_->aes, rest, 3);
+        const size_t tail = bytes.size() % 16;
+        std::memcpy(out + 16 * n_blocks, rest, tail);
+        std::memcpy(impl_->aes.key, rest + 16, 32);
+        std::memset(rest, 0, sizeof(rest));
+    }
+
+    std::vector<RandomEngine> RandomEngine::fork(size_t k)
+    {
+        // the seed of the i-th child is 32 bytes drawn from this engine followed by i
+        char seed[40];
+        fill(std::span{ seed, 32 });
+
+        std::vector<RandomEngine> children;
+        children.reserve(k);
+        for(size_t i = 0; i < k; ++i)
+        {
+            for(size_t j = 0; j < 8; ++j)
+            {
+                seed[32 + j] = (char)((std::uint64_t)i >> (8 * j));
+            }
+            children.emplace_back(std::span{ seed }, backend());
+        }
+        std::memset(seed, 0, sizeof(seed));
+        return children;
+    }
+
+    RandomEngine RandomEngine::split()
+    {
+        return std::move(fork(1).front());
+    }
 }
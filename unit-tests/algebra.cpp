@@ -1,4 +1,6 @@
 #include <array>
+#include <functional>
+#include <stdexcept>
 #include <vector>
 
 #include <catch2/catch_test_macros.hpp>
@@ -42,6 +44,44 @@ TEST_CASE("Ranged substitutions evaluate once for every supplied value", "[algeb
     STATIC_REQUIRE(results[2] == 10);
 }
 
+namespace
+{
+    // counts its evaluations, hoist evaluates it once
+    struct lazy_square
+    {
+        int value;
+        int* evaluations;
+
+        operator int() const
+        {
+            ++*evaluations;
+            return value * value;
+        }
+
+        friend int hoist(const lazy_square& self)
+        {
+            return self;
+        }
+    };
+}
+
+TEST_CASE("Ranged substitutions evaluate the invariant lazy values once", "[algebra]")
+{
+    int evaluations = 0;
+    const lazy_square square{ 3, &evaluations };
+
+    auto results = (x * 10 + square)(x.in[4]) | materialize;
+
+    REQUIRE(results.size() == 4);
+    CHECK(results[0] == 9);
+    CHECK(results[3] == 39);
+    CHECK(evaluations == 1);
+
+    auto total = (y * (x * 10 + square))(x.in[4])(y = 2) | materialize;
+    CHECK(total[1] == 38);
+    CHECK(evaluations == 2);
+}
+
 TEST_CASE("Symbolic subscripting works with algebraic ranges", "[algebra]")
 {
     static constexpr auto values = std::array{ 2, 3, 5, 7, 11 } | algebraic;
@@ -86,6 +126,53 @@ TEST_CASE("except removes every requested value", "[algebra]")
     CHECK(results[2] == 5);
 }
 
+TEST_CASE("zip_transform combines ranges element by element", "[algebra]")
+{
+    static constexpr auto a = std::array{ 1, 2, 3 } | algebraic;
+    static constexpr auto b = std::array{ 10, 20, 30 } | algebraic;
+
+    SECTION("random access without materialization")
+    {
+        constexpr auto sums = zip_transform(std::plus<>{}, a, b);
+
+        STATIC_REQUIRE(std::ranges::random_access_range<decltype(unwrap(sums))>);
+        STATIC_REQUIRE(sums.size() == 3);
+        STATIC_REQUIRE(sums[0] == 11);
+        STATIC_REQUIRE(sums[2] == 33);
+        STATIC_REQUIRE(sums[i](i = 1) == 22);
+    }
+
+    SECTION("symbolic ranges")
+    {
+        auto products = zip_transform(std::multiplies<>{}, a, x)(x = b) | materialize;
+
+        REQUIRE(products.size() == 3);
+        CHECK(products[0] == 10);
+        CHECK(products[1] == 40);
+        CHECK(products[2] == 90);
+    }
+
+    SECTION("tuples of references")
+    {
+        std::array values{ 1, 2, 3 };
+        for(auto&& [value, increment] : zip(values, b))
+        {
+            value += increment;
+        }
+
+        CHECK(values == std::array{ 11, 22, 33 });
+    }
+
+    SECTION("ranges of different lengths")
+    {
+        const auto longer = std::array{ 1, 2, 3, 4 } | algebraic;
+
+        CHECK_THROWS_AS(zip_transform(std::plus<>{}, longer, b), std::runtime_error);
+        CHECK_THROWS_AS(zip(b, longer), std::runtime_error);
+        CHECK_THROWS_AS(zip_transform(std::multiplies<>{}, longer, x)(x = b), std::runtime_error);
+    }
+}
+
 TEST_CASE("unwrap exposes the underlying range", "[algebra]")
 {
     std::array values{ 1, 2, 3 };
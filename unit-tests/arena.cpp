@@ -0,0 +1,116 @@
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <crypto12381/arena.hpp>
+#include <crypto12381/crypto12381.hpp>
+
+using namespace crypto12381;
+
+namespace
+{
+    // counts the allocations which reach the default resource
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        size_t count = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++count;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+}
+
+TEST_CASE("Materialized ranges take their memory from the arena of the thread which holds the results", "[arena]")
+{
+    auto random = create_random_engine("arena seed");
+    std::vector<std::byte> buffer(4096);
+    {
+        Arena arena{ buffer, arena_scope::results };
+        auto numbers = random-select_in<Zp>(8) | materialize;
+        CHECK(numbers.base().get_allocator().resource() == arena.resource());
+        {
+            Arena inner{ 1024, arena_scope::results };
+            auto squares = sequence(0, 8) | transform([](int k){ return k * k; }) | materialize;
+            CHECK(squares.base().get_allocator().resource() == inner.resource());
+        }
+        auto encoded = encode_to<Zp>(std::string_view{ "a message of a few units" });
+        CHECK(encoded.base().get_allocator().resource() == arena.resource());
+        {
+            Arena temporaries;
+            auto squares = sequence(0, 8) | transform([](int k){ return k * k; }) | materialize;
+            CHECK(squares.base().get_allocator().resource() == arena.resource());
+        }
+    }
+    auto numbers = random-select_in<Zp>(8) | materialize;
+    CHECK(numbers.base().get_allocator().resource() == std::pmr::get_default_resource());
+}
+
+TEST_CASE("Ranges made in an arena of temporaries outlive it", "[arena]")
+{
+    auto first = create_random_engine("arena lifetime seed");
+    auto second = create_random_engine("arena lifetime seed");
+
+    auto numbers = [&]
+    {
+        Arena arena;
+        return first-select_in<Zp>(5) | materialize;
+    }();
+    const auto expected = second-select_in<Zp>(5);
+
+    CHECK(numbers.base().get_allocator().resource() == std::pmr::get_default_resource());
+    REQUIRE(numbers.size() == 5);
+    for(size_t k = 0; k < 5; ++k)
+    {
+        CHECK(numbers[k] == expected[k]);
+    }
+}
+
+TEST_CASE("A verification in an arena allocates nothing from the default resource", "[arena][G1]")
+{
+    auto random = create_random_engine("arena verification seed");
+    constexpr size_t n = 16;
+    std::vector<serialized_field<G1>> h_bytes;
+    for(size_t k = 0; k < n; ++k)
+    {
+        h_bytes.push_back(serialize(random-select_in<*G1>));
+    }
+    const std::string_view message{ "a message which is encoded into several numbers of Zp" };
+    const auto expected = [&] -> serialized_field<G1>
+    {
+        auto h = parse<G1>(h_bytes);
+        auto m = encode_to<Zp>(message);
+        return serialize(Π[m.size()](h[i] ^ vartime(m[i])));
+    }();
+
+    counting_resource counting;
+    auto* const previous = std::pmr::set_default_resource(&counting);
+    std::vector<std::byte> buffer(1 << 20);
+    {
+        Arena arena{ buffer, arena_scope::results };
+        auto h = parse<G1>(h_bytes);
+        auto m = encode_to<Zp>(message);
+        auto A = Π[m.size()](h[i] ^ vartime(m[i]));
+        auto B = Π[m.size()](h[i] ^ m[i]);
+        CHECK(static_cast<serialized_field<G1>>(serialize(A)) == expected);
+        CHECK(A == B);
+    }
+    std::pmr::set_default_resource(previous);
+    CHECK(counting.count == 0);
+}
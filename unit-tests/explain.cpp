@@ -0,0 +1,122 @@
+#include <optional>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <crypto12381/crypto12381.hpp>
+#include <crypto12381/explain.hpp>
+
+using namespace crypto12381;
+
+TEST_CASE("A product of G1 powers is explained as a single multi-scalar multiplication", "[explain][G1]")
+{
+    auto random = create_random_engine("explain product seed");
+    constexpr size_t n = 40;
+    std::vector<serialized_field<G1>> bytes;
+    for(size_t k = 0; k < n; ++k)
+    {
+        bytes.push_back(serialize(random-select_in<*G1>));
+    }
+    const auto m = random-select_in<Zp>(n) | materialize;
+
+    const auto plan = explain([&]
+    {
+        auto h = parse<G1>(bytes);
+        return Π[n](h[i] ^ m[i]);
+    });
+
+    CHECK(plan.multi_scalar_multiplications == 1);
+    CHECK(plan.msm_points == n);
+    CHECK(plan.parses == n);
+    CHECK(plan.allocations > 0);
+    CHECK(plan.report().starts_with("multi-scalar multiplications: 1 (40 points)\n"));
+
+    const auto h = parse<G1>(bytes);
+    const auto parallel_plan = explain([&]{ return Π[parallel(2), n](h[i] ^ vartime(m[i])); });
+    CHECK(parallel_plan.multi_scalar_multiplications == 2);
+    CHECK(parallel_plan.msm_points == n);
+    CHECK(parallel_plan.parses == 0);
+    // the bases and numbers of each multi-scalar multiplication, on whichever thread took it
+    CHECK(parallel_plan.allocations >= 2 * parallel_plan.multi_scalar_multiplications);
+}
+
+TEST_CASE("A comparison of pairings is explained with a single final exponentiation", "[explain][GT]")
+{
+    auto random = create_random_engine("explain pairing seed");
+    // the selected points are lazy powers of the generators, the parsed ones are not
+    const serialized_field<G1 ^ 2, G2 ^ 2> bytes = serialize(
+        random-select_in<*G1>, random-select_in<*G1>, random-select_in<*G2>, random-select_in<*G2>
+    );
+    const auto [A, B, C, D] = parse<(G1 ^ 2) | (G2 ^ 2)>(bytes);
+    const auto lazy = random-select_in<*G1>;
+    CHECK(explain([&]{ return pair(lazy, C) == pair(B, D); }).multiplications == 1);
+
+    const auto plan = explain([&]{ return pair(A, C) == pair(B, D); });
+    CHECK(plan.miller_loops == 2);
+    CHECK(plan.final_exponentiations == 1);
+    CHECK(plan.multiplications == 0);
+
+    const auto separate_plan = explain([&]{ return pair(A, C).GT_point() == pair(B, D).GT_point(); });
+    CHECK(separate_plan.miller_loops == 2);
+    CHECK(separate_plan.final_exponentiations == 2);
+}
+
+TEST_CASE("A product of pairings with an invariant pairing is explained with a single final exponentiation", "[explain][GT]")
+{
+    auto random = create_random_engine("explain pairing product seed");
+    constexpr size_t n = 4;
+    std::vector<serialized_field<G1>> bytes;
+    for(size_t k = 0; k < n; ++k)
+    {
+        bytes.push_back(serialize(random-select_in<*G1>));
+    }
+    const auto P = parse<G1>(bytes);
+    const serialized_field<G1, G2 ^ 2> other_bytes = serialize(
+        random-select_in<*G1>, random-select_in<*G2>, random-select_in<*G2>
+    );
+    const auto [A, Q, B] = parse<G1 | (G2 ^ 2)>(other_bytes);
+
+    // the invariant pairing takes a single Miller loop, the product a single final exponentiation
+    const auto plan = explain([&]{ return Π[n](pair(P[i], Q) * pair(A, B)).GT_point(); });
+    CHECK(plan.miller_loops == n + 1);
+    CHECK(plan.final_exponentiations == 1);
+
+    std::optional expected{ pair(A, B).GT_point() ^ make_Zp(n) };
+    for(const auto& p : P)
+    {
+        expected.emplace(*expected * pair(p, Q));
+    }
+    CHECK(Π[n](pair(P[i], Q) * pair(A, B)) == *expected);
+    CHECK(Π[n](pair(P[i], Q)) * (pair(A, B).GT_point() ^ make_Zp(n)) == *expected);
+}
+
+TEST_CASE("Ranges made in the scope of an explanation outlive it", "[explain][Zp]")
+{
+    auto first = create_random_engine("explain lifetime seed");
+    auto second = create_random_engine("explain lifetime seed");
+
+    auto explained = [&]
+    {
+        Explain scope;
+        return first-select_in<Zp>(5);
+    }();
+    const auto expected = second-select_in<Zp>(5);
+
+    REQUIRE(explained.size() == 5);
+    for(size_t k = 0; k < 5; ++k)
+    {
+        CHECK(explained[k] == expected[k]);
+    }
+}
+
+TEST_CASE("Nested explanations are counted in the enclosing ones", "[explain][Zp]")
+{
+    const auto x = make_Zp(7);
+    Explain outer;
+    const auto inner = explain([&]{ return inverse(x); });
+
+    CHECK(inner.Zp_and_batch_inversions == 1);
+    CHECK(inner.report() == "Zp and batch inversions: 1\n");
+    CHECK(outer.plan().Zp_and_batch_inversions == 1);
+    CHECK(EvaluationPlan{} == explain([]{}));
+}
@@ -1,4 +1,9 @@
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <ranges>
 #include <stdexcept>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -13,6 +18,17 @@ namespace
         const serialized_field<G1> bytes = serialize(random-select_in<*G1>);
         return parse<G1>(bytes);
     }
+
+    // n parsed points, which are affine unlike the lazy powers of select_in
+    auto select_g1(RandomEngine& random, std::size_t n)
+    {
+        std::vector<serialized_field<G1>> bytes;
+        for(std::size_t k = 0; k < n; ++k)
+        {
+            bytes.push_back(serialize(random-select_in<*G1>));
+        }
+        return parse<G1>(bytes);
+    }
 }
 
 TEST_CASE("G1 group operations satisfy their laws", "[G1][arithmetic]")
@@ -97,6 +113,154 @@ TEST_CASE("G1 double scalar multiplication matches separate operations", "[G1][a
     }
 }
 
+TEST_CASE("G1 multiplication by public numbers matches constant time multiplication", "[G1][arithmetic]")
+{
+    auto random = create_random_engine("G1 public multiplication seed");
+    const auto first = select_g1(random);
+    const auto second = select_g1(random);
+    const auto identity = first / first;
+    const auto [x, y] = random-select_in<Zp ^ 2>;
+
+    CHECK((first ^ vartime(x)) == (first ^ x));
+    CHECK((first ^ vartime(x * y)) == ((first ^ x) ^ y));
+    CHECK((first ^ vartime(make_Zp(0))) == identity);
+    CHECK((first ^ vartime(make_Zp(1))) == first);
+    CHECK((first ^ vartime(make_Zp(-1))) == inverse(first));
+    CHECK((first ^ vartime(x)) * (second ^ vartime(y)) == (first ^ x) * (second ^ y));
+}
+
+TEST_CASE("Products of G1 powers by public numbers match constant time products", "[G1][arithmetic]")
+{
+    auto random = create_random_engine("G1 public product seed");
+
+    // the long products take the bucket method
+    for(std::size_t n : { 1uz, 2uz, 9uz, 40uz, 300uz })
+    {
+        CAPTURE(n);
+        const auto x = random-select_in<Zp>(n);
+        const auto h = select_g1(random, n);
+
+        CHECK(Π[n](h[i] ^ vartime(x[i])) == Π[n](h[i] ^ x[i]));
+    }
+}
+
+TEST_CASE("Products of zipped G1 powers match products of subscripted powers", "[G1][arithmetic]")
+{
+    auto random = create_random_engine("G1 zipped product seed");
+    constexpr size_t n = 12;
+    const auto x = random-select_in<Zp>(n);
+    const auto h = select_g1(random, n);
+
+    CHECK(product(zip_transform(std::bit_xor<>{}, h, x)) == Π[n](h[i] ^ x[i]));
+}
+
+TEST_CASE("Products of G1 powers by bounded numbers match products by full numbers", "[G1][arithmetic]")
+{
+    auto random = create_random_engine("G1 bounded product seed");
+
+    // the long products take the constant time buckets
+    for(std::size_t n : { 1uz, 3uz, 40uz })
+    {
+        CAPTURE(n);
+        const auto h = select_g1(random, n);
+        std::vector<serialized_field<Zp>> number_bytes;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            number_bytes.push_back(serialize(random-select_in<Zp_bits<128>>));
+        }
+        const auto r = parse<Zp_bits<128>>(number_bytes);
+        const auto x = parse<Zp>(number_bytes);
+
+        CHECK(Π[n](h[i] ^ r[i]) == Π[n](h[i] ^ x[i]));
+        CHECK(Π[n](h[i] ^ r[i]) == Π[n](h[i] ^ vartime(x[i])));
+    }
+}
+
+TEST_CASE("Parallel products of G1 powers match the sequential ones", "[G1][arithmetic][parallel]")
+{
+    auto random = create_random_engine("G1 parallel product seed");
+
+    constexpr std::size_t n = 100;
+    const auto h = select_g1(random, n);
+    const auto x = random-select_in<Zp>(n);
+
+    const auto expected = Π[n](h[i] ^ x[i]);
+    CHECK(Π[parallel, n](h[i] ^ x[i]) == expected);
+    CHECK(Π[parallel(2), n](h[i] ^ vartime(x[i])) == expected);
+    CHECK(product(parallel, h) == product(h));
+}
+
+TEST_CASE("G1 product streams match products of materialized ranges", "[G1][arithmetic]")
+{
+    auto random = create_random_engine("G1 product stream seed");
+
+    constexpr std::size_t n = 50;
+    const auto h = select_g1(random, n);
+    std::vector<serialized_field<Zp>> number_bytes;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        number_bytes.push_back(serialize(random-select_in<Zp_bits<128>>));
+    }
+    const auto x = parse<Zp>(number_bytes);
+    const auto r = parse<Zp_bits<128>>(number_bytes);
+    const auto expected = Π[n](h[i] ^ x[i]);
+
+    SECTION("secret numbers in chunks")
+    {
+        G1ProductStream stream{ n };
+        for(std::size_t begin = 0; begin < n; begin += 16)
+        {
+            stream.add(h | std::views::drop(begin) | std::views::take(16), x | std::views::drop(begin) | std::views::take(16));
+        }
+        CHECK(stream.result() == expected);
+    }
+
+    SECTION("public and secret powers one by one")
+    {
+        G1ProductStream stream{ n };
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            if(i % 2 == 0)
+            {
+                stream.add(h[i] ^ vartime(x[i]));
+            }
+            else
+            {
+                stream.add(h[i] ^ x[i]);
+            }
+        }
+        CHECK(stream.result() == expected);
+    }
+
+    SECTION("bounded numbers")
+    {
+        G1ProductStream stream{ n, 128 };
+        stream.add(h | std::views::take(1), r | std::views::take(1));
+        const auto first = stream.result();
+        stream.add(h | std::views::drop(1), r | std::views::drop(1));
+        CHECK(first == (h[0] ^ x[0]));
+        CHECK(stream.result() == expected);
+        CHECK_THROWS_AS(stream.add(h[0] ^ x[0]), std::runtime_error);
+    }
+}
+
+TEST_CASE("G1 multiplication by bounded numbers matches full multiplication", "[G1][arithmetic]")
+{
+    auto random = create_random_engine("G1 bounded multiplication seed");
+    const auto first = select_g1(random);
+    const auto second = select_g1(random);
+    const auto identity = first / first;
+    const auto r = random-select_in<Zp_bits<128>>;
+    const auto s = random-select_in<Zp_bits<64>>;
+
+    CHECK((first ^ r) == (first ^ r.Zp_number()));
+    CHECK((first ^ s) == (first ^ s.Zp_number()));
+    CHECK((first ^ bounded<64>(make_Zp(0))) == identity);
+    CHECK((first ^ bounded<1>(make_Zp(1))) == first);
+    CHECK((first ^ bounded<64>(make_Zp(std::numeric_limits<std::uint64_t>::max()))) == (first ^ make_Zp(std::numeric_limits<std::uint64_t>::max())));
+    CHECK((first ^ r) * (second ^ s) == (first ^ r.Zp_number()) * (second ^ s.Zp_number()));
+}
+
 TEST_CASE("Selecting from nonidentity G1 excludes the identity", "[G1][random]")
 {
     auto random = create_random_engine("nonidentity G1 seed");
@@ -136,3 +300,38 @@ TEST_CASE("G1 parsing rejects invalid encodings", "[G1][serialization]")
 
     CHECK_THROWS_AS(parse<G1>(invalid_bytes), std::runtime_error);
 }
+
+TEST_CASE("G1 parsing accepts only the compressed prefixes", "[G1][serialization]")
+{
+    auto random = create_random_engine("G1 prefix seed");
+    const auto point = select_g1(random);
+    const serialized_field<G1> bytes = serialize(point);
+    CHECK(parse<G1>(bytes) == point);
+
+    for(const char prefix : { 0x01, 0x04, 0x12, 0x42 })
+    {
+        CAPTURE(int(prefix));
+        auto other = bytes;
+        other.front() = prefix;
+        CHECK_THROWS_AS(parse<G1>(other), std::runtime_error);
+    }
+}
+
+TEST_CASE("G1 uncompressed serialization round-trips", "[G1][serialization]")
+{
+    auto random = create_random_engine("G1 uncompressed seed");
+    const auto point = select_g1(random);
+    const auto identity = point / point;
+
+    STATIC_REQUIRE(serialized_size<G1u> == 97);
+    const serialized_field<G1u> bytes = serialize_as<G1u>(point);
+    CHECK(bytes.front() == 0x04);
+    CHECK(parse<G1u>(bytes) == point);
+
+    const serialized_field<G1u> identity_bytes = serialize_as<G1u>(identity);
+    CHECK(parse<G1u>(identity_bytes) == identity);
+
+    auto compressed = bytes;
+    compressed.front() = 0x02;
+    CHECK_THROWS_AS(parse<G1u>(compressed), std::runtime_error);
+}
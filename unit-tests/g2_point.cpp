@@ -77,6 +77,41 @@ TEST_CASE("G2 scalar multiplication satisfies module laws", "[G2][arithmetic]")
     }
 }
 
+TEST_CASE("G2 multiplication by public numbers matches constant time multiplication", "[G2][arithmetic]")
+{
+    auto random = create_random_engine("G2 public multiplication seed");
+    const auto point = select_g2(random);
+    const auto identity = point / point;
+    const auto [x, y] = random-select_in<Zp ^ 2>;
+
+    CHECK((point ^ vartime(x)) == (point ^ x));
+    CHECK((point ^ vartime(x * y)) == ((point ^ x) ^ y));
+    CHECK((point ^ vartime(make_Zp(0))) == identity);
+    CHECK((point ^ vartime(make_Zp(1))) == point);
+    CHECK((point ^ vartime(make_Zp(-1))) == inverse(point));
+}
+
+TEST_CASE("G2 multiplication by bounded numbers matches full multiplication", "[G2][arithmetic]")
+{
+    auto random = create_random_engine("G2 bounded multiplication seed");
+    const auto point = select_g2(random);
+    const auto identity = point / point;
+
+    CHECK((point ^ bounded<64>(make_Zp(0))) == identity);
+    CHECK((point ^ bounded<1>(make_Zp(1))) == point);
+    for(int iteration = 0; iteration < 4; ++iteration)
+    {
+        CAPTURE(iteration);
+        const auto r = random-select_in<Zp_bits<128>>;
+        const auto s = random-select_in<Zp_bits<64>>;
+        const auto t = random-select_in<Zp_bits<100>>;
+
+        CHECK((point ^ r) == (point ^ r.Zp_number()));
+        CHECK((point ^ s) == (point ^ s.Zp_number()));
+        CHECK((point ^ t) == (point ^ t.Zp_number()));
+    }
+}
+
 TEST_CASE("Selecting from nonidentity G2 excludes the identity", "[G2][random]")
 {
     auto random = create_random_engine("nonidentity G2 seed");
@@ -116,3 +151,38 @@ TEST_CASE("G2 parsing rejects invalid encodings", "[G2][serialization]")
 
     CHECK_THROWS_AS(parse<G2>(invalid_bytes), std::runtime_error);
 }
+
+TEST_CASE("G2 parsing accepts only the compressed prefixes", "[G2][serialization]")
+{
+    auto random = create_random_engine("G2 prefix seed");
+    const auto point = select_g2(random);
+    const serialized_field<G2> bytes = serialize(point);
+    CHECK(parse<G2>(bytes) == point);
+
+    for(const char prefix : { 0x01, 0x04, 0x12, 0x42 })
+    {
+        CAPTURE(int(prefix));
+        auto other = bytes;
+        other.front() = prefix;
+        CHECK_THROWS_AS(parse<G2>(other), std::runtime_error);
+    }
+}
+
+TEST_CASE("G2 uncompressed serialization round-trips", "[G2][serialization]")
+{
+    auto random = create_random_engine("G2 uncompressed seed");
+    const auto point = select_g2(random);
+    const auto identity = point / point;
+
+    STATIC_REQUIRE(serialized_size<G2u> == 193);
+    const serialized_field<G2u> bytes = serialize_as<G2u>(point);
+    CHECK(bytes.front() == 0x04);
+    CHECK(parse<G2u>(bytes) == point);
+
+    const serialized_field<G2u> identity_bytes = serialize_as<G2u>(identity);
+    CHECK(parse<G2u>(identity_bytes) == identity);
+
+    auto compressed = bytes;
+    compressed.front() = 0x02;
+    CHECK_THROWS_AS(parse<G2u>(compressed), std::runtime_error);
+}
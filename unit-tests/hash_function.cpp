@@ -0,0 +1,184 @@
+#include <array>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <crypto12381/hash_function.hpp>
+#include <crypto12381/set.hpp>
+#include <crypto12381/zp_number.hpp>
+#include <crypto12381/g1_point.hpp>
+#include <crypto12381/g2_point.hpp>
+
+using namespace crypto12381;
+
+namespace
+{
+    std::string sha256_hex(std::string_view message, size_t piece_size)
+    {
+        detail::sha256_state state;
+        detail::sha256_init(state);
+        for(size_t i = 0; i < message.size(); i += piece_size)
+        {
+            const auto piece = message.substr(i, piece_size);
+            detail::sha256_process(state, std::span{ piece.data(), piece.size() });
+        }
+        char digest[32];
+        detail::sha256_hash(state, digest);
+
+        std::string result;
+        for(const auto byte : digest)
+        {
+            char hex[3];
+            std::snprintf(hex, sizeof(hex), "%02x", (unsigned char)byte);
+            result += hex;
+        }
+        return result;
+    }
+
+    // hashed during the static initialization, which may come before the one of the library
+    const std::string static_digest = sha256_hex("abc", 64);
+}
+
+TEST_CASE("SHA-256 matches the FIPS 180-2 test vectors", "[hash]")
+{
+    CHECK(sha256_hex("", 64) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK(sha256_hex("abc", 64) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK(
+        sha256_hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 64)
+        == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"
+    );
+    CHECK(
+        sha256_hex(std::string(1000000, 'a'), 1000)
+        == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"
+    );
+}
+
+TEST_CASE("The 64 bytes SHA-256 digest is expand_message_xmd", "[hash]")
+{
+    // RFC 9380, K.1 expand_message_xmd(SHA-256)
+    constexpr std::string_view domain = "QUUX-V01-CS02-with-expander-SHA256-128";
+    auto expand = [&](std::string_view message, size_t size)
+    {
+        detail::sha256_state state;
+        hash_functions::sha256::init(state);
+        detail::sha256_process(state, std::span{ message.data(), message.size() });
+        std::vector<char> output(size);
+        detail::sha256_expand_message_xmd(state, std::span{ domain.data(), domain.size() }, output);
+
+        std::string result;
+        for(const auto byte : output)
+        {
+            char hex[3];
+            std::snprintf(hex, sizeof(hex), "%02x", (unsigned char)byte);
+            result += hex;
+        }
+        return result;
+    };
+
+    CHECK(expand("", 0x20) == "68a985b87eb6b46952128911f2a4412bbc302a9d759667f87f7a21d803f07235");
+    CHECK(expand("abc", 0x20) == "d8ccab23b5985ccea865c6c97b6e5b8350e794e603b4b97902f53a8a0d605615");
+    CHECK(
+        expand("", 0x80) 
+        == "af84c27ccfd45d41914fdff5df25293e221afc53d8ad2ac06d5e3e29485dadbee0d121587713a3e0dd4d5e69e93eb7cd"
+           "4f5df4cd103e188cf60cb02edc3edf18eda8576c412b18ffb658e3dd6ec849469b979d444cf7b26911a08e63cf31f9dc"
+           "c541708d3491184472c2c29bb749d4286b004ceb5ee6b9a7fa5b646c993f0ced"
+    );
+}
+
+TEST_CASE("SHA-256 hashes during the static initialization", "[hash]")
+{
+    CHECK(static_digest == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST_CASE("SHA-256 does not depend on how the input is split", "[hash]")
+{
+    const auto message = std::string(300, 'x') + "crypto12381";
+    const auto whole = sha256_hex(message, message.size());
+    for(const size_t piece_size : { 1uz, 7uz, 63uz, 64uz, 65uz, 128uz })
+    {
+        CHECK(sha256_hex(message, piece_size) == whole);
+    }
+}
+
+TEST_CASE("hash_with selects the hash function", "[hash][Zp][G1]")
+{
+    auto random = create_random_engine("hash function seed");
+    const auto x = random-select_in<Zp>;
+
+    const auto sha3 = hash(x, 7).to(Zp);
+    const auto sha2 = hash_with<hash_functions::sha256>(x, 7).to(Zp);
+    CHECK(sha2 == hash_with<hash_functions::sha256>(x, 7).to(Zp));
+    CHECK(sha3 == hash_with<hash_functions::sha3_512>(x, 7).to(Zp));
+    CHECK(sha2 != sha3);
+
+    const auto point = hash_with<hash_functions::sha256>(x).to(G1);
+    CHECK(point == hash_with<hash_functions::sha256>(x).to(G1));
+    CHECK(point != hash(x).to(G1));
+
+    auto prefix = hash_with<hash_functions::sha256>(x);
+    CHECK((prefix.fork() | 7).to(Zp) == sha2);
+}
+
+TEST_CASE("hash_each matches hashing each state", "[hash][Zp][G1]")
+{
+    auto random = create_random_engine("hash each seed");
+    const auto x = random-select_in<Zp>;
+    using state_t = decltype(hash(x));
+
+    std::vector<state_t> states;
+    for(int k = 0; k < 5; ++k)
+    {
+        states.push_back(hash(x, k));
+    }
+    const auto points = hash_each(states).to(G1);
+    REQUIRE(points.size() == 5);
+    for(int k = 0; k < 5; ++k)
+    {
+        CHECK(points[k] == hash(x, k).to(G1));
+        CHECK(points[k].is_in_subgroup());
+    }
+    // the states of a borrowed range are forked, so they stay usable
+    CHECK(std::move(states[4]).to(G1) == points[4]);
+    const std::vector<detail::G1Point> as_vector = hash_each(states).to(G1);
+    CHECK(as_vector[3] == points[3]);
+
+    std::vector<state_t> more;
+    more.push_back(hash(x, 0));
+    more.push_back(hash(x, 1));
+    const auto numbers = hash_each(std::move(more)).to(Zp);
+    CHECK(numbers[0] == hash(x, 0).to(Zp));
+    CHECK(numbers[1] == hash(x, 1).to(Zp));
+
+    std::vector<state_t> none;
+    CHECK(hash_each(none).to(G1).empty());
+}
+
+TEST_CASE("Hashing to G2 is deterministic and lands in the subgroup", "[hash][G2]")
+{
+    auto random = create_random_engine("hash to G2 seed");
+    const auto x = random-select_in<Zp>;
+
+    const auto point = hash(x, 7).to(G2);
+    CHECK(point == hash(x, 7).to(G2));
+    CHECK(point != hash(x, 8).to(G2));
+    CHECK(point != hash_with<hash_functions::sha256>(x, 7).to(G2));
+    CHECK(point.is_in_subgroup());
+
+    using state_t = decltype(hash(x));
+    std::vector<state_t> states;
+    for(int k = 0; k < 3; ++k)
+    {
+        states.push_back(hash(x, k));
+    }
+    const auto points = hash_each(states).to(G2);
+    REQUIRE(points.size() == 3);
+    for(int k = 0; k < 3; ++k)
+    {
+        CHECK(points[k] == hash(x, k).to(G2));
+        CHECK(points[k].is_in_subgroup());
+    }
+    CHECK(std::move(states[2]).to(G2) == points[2]);
+}
@@ -0,0 +1,56 @@
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <crypto12381/algebra.hpp>
+#include <crypto12381/index_set.hpp>
+
+using namespace crypto12381;
+
+TEST_CASE("Index sets keep their members in increasing order", "[index_set]")
+{
+    const index_set set{ 130, { 129, 3, 64, 0, 3, 63 } };
+
+    CHECK(set.bound() == 130);
+    CHECK(set.size() == 5);
+    CHECK(set.contains(64));
+    CHECK_FALSE(set.contains(65));
+    CHECK_FALSE(set.contains(130));
+    CHECK(std::vector<size_t>(set.begin(), set.end()) == std::vector<size_t>{ 0, 3, 63, 64, 129 });
+    CHECK(index_set{ 130 }.empty());
+    CHECK_THROWS_AS((index_set{ 130, { 130 } }), std::runtime_error);
+}
+
+TEST_CASE("Index sets combine with set operations", "[index_set]")
+{
+    const index_set revealed{ 70, { 1, 2, 65 } };
+    const index_set hidden = ~revealed;
+
+    CHECK(hidden.size() == 67);
+    CHECK_FALSE(hidden.contains(65));
+    CHECK(hidden.contains(69));
+    CHECK((revealed | hidden).size() == 70);
+    CHECK((revealed & hidden).empty());
+    CHECK((revealed & index_set{ 3, { 0, 2 } }) == index_set{ 3, { 2 } });
+    CHECK((hidden - index_set{ 70, { 0, 69 } }).size() == 65);
+    CHECK(revealed.except(index_set{ 2, { 1 } }) == index_set{ 70, { 2, 65 } });
+}
+
+TEST_CASE("Index sets select the values of symbols and except them from ranges", "[index_set][algebra]")
+{
+    const index_set set{ 8, { 1, 4, 6 } };
+
+    auto squares = (i * i)(i.in(set)) | materialize;
+    REQUIRE(squares.size() == 3);
+    CHECK(squares[0] == 1);
+    CHECK(squares[1] == 16);
+    CHECK(squares[2] == 36);
+
+    auto rest = sequence(8uz).except(set) | materialize;
+    CHECK(std::vector<size_t>(rest.begin(), rest.end()) == std::vector<size_t>{ 0, 2, 3, 5, 7 });
+
+    auto doubled = (i + i)(i.in[8uz].except(set, 0uz)) | materialize;
+    CHECK(std::vector<size_t>(doubled.begin(), doubled.end()) == std::vector<size_t>{ 4, 6, 10, 14 });
+}
@@ -1,3 +1,5 @@
+#include <stdexcept>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include <crypto12381/liner_pair.hpp>
@@ -159,6 +161,38 @@ TEST_CASE("GT operations satisfy group and exponent laws", "[GT][arithmetic]")
     }
 }
 
+TEST_CASE("GT exponentiation by public numbers matches constant time exponentiation", "[GT][arithmetic]")
+{
+    auto random = create_random_engine("GT public exponentiation seed");
+    const auto g1 = select_g1(random);
+    const auto g2 = select_g2(random);
+    const auto element = evaluate_pairing(g1, g2);
+    const auto identity = element / element;
+    const auto [x, y] = random-select_in<Zp ^ 2>;
+
+    CHECK((element ^ vartime(x)) == (element ^ x));
+    CHECK((element ^ vartime(x * y)) == ((element ^ x) ^ y));
+    CHECK((element ^ vartime(make_Zp(0))) == identity);
+    CHECK((element ^ vartime(make_Zp(-1))) == inverse(element));
+    CHECK((pair(g1, g2) ^ vartime(x)) == evaluate_pairing(g1 ^ x, g2));
+}
+
+TEST_CASE("GT exponentiation by bounded numbers matches full exponentiation", "[GT][arithmetic]")
+{
+    auto random = create_random_engine("GT bounded exponentiation seed");
+    const auto g1 = select_g1(random);
+    const auto g2 = select_g2(random);
+    const auto element = evaluate_pairing(g1, g2);
+    const auto identity = element / element;
+    const auto r = random-select_in<Zp_bits<128>>;
+    const auto s = random-select_in<Zp_bits<64>>;
+
+    CHECK((element ^ r) == (element ^ r.Zp_number()));
+    CHECK((element ^ s) == (element ^ s.Zp_number()));
+    CHECK((element ^ bounded<64>(make_Zp(0))) == identity);
+    CHECK((pair(g1, g2) ^ r) == evaluate_pairing(g1 ^ r, g2));
+}
+
 TEST_CASE("GT serialization", "[GT][serialization]")
 {
     auto random = create_random_engine("GT serialization seed");
@@ -179,3 +213,21 @@ TEST_CASE("GT serialization", "[GT][serialization]")
         CHECK(parse<GT>(bytes) == identity);
     }
 }
+
+TEST_CASE("Checked GT parsing rejects elements outside of the subgroup", "[GT][serialization]")
+{
+    auto random = create_random_engine("GT checked parse seed");
+    const auto value = evaluate_pairing(select_g1(random), select_g2(random));
+    const auto identity = value / value;
+
+    const serialized_field<GT> bytes = serialize(value);
+    CHECK(parse_checked<GT>(bytes) == value);
+
+    const serialized_field<GT> identity_bytes = serialize(identity);
+    CHECK(parse_checked<GT>(identity_bytes) == identity);
+
+    auto modified = bytes;
+    modified.back() ^= 1;
+    CHECK_FALSE(parse<GT>(modified).is_in_subgroup());
+    CHECK_THROWS_AS(parse_checked<GT>(modified), std::runtime_error);
+}
@@ -0,0 +1,92 @@
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <crypto12381/parse_cache.hpp>
+
+using namespace crypto12381;
+
+TEST_CASE("Cached parsing returns the same points as parsing", "[parse_cache][G1][G2]")
+{
+    auto random = create_random_engine("parse cache seed");
+    const serialized_field<G1> g1_bytes = serialize(random-select_in<*G1>);
+    const serialized_field<G2> g2_bytes = serialize(random-select_in<*G2>);
+
+    ParseCache cache{ 16 };
+    CHECK(parse<G1>(g1_bytes, cache) == parse<G1>(g1_bytes));
+    CHECK(parse<G1>(g1_bytes, cache) == parse<G1>(g1_bytes));
+    CHECK(parse<G2>(g2_bytes, cache) == parse<G2>(g2_bytes));
+    CHECK(cache.size<G1>() == 1);
+    CHECK(cache.size<G2>() == 1);
+
+    const serialized_field<Zp, G1, G2> record = serialize(make_Zp(5), parse<G1>(g1_bytes), parse<G2>(g2_bytes));
+    const auto [scalar, g1, g2] = parse<Zp | G1 | G2>(record, cache);
+    CHECK(scalar == make_Zp(5));
+    CHECK(g1 == parse<G1>(g1_bytes));
+    CHECK(g2 == parse<G2>(g2_bytes));
+    CHECK(cache.size<G1>() == 1);
+    CHECK(cache.size<G2>() == 1);
+
+    const auto cached = parse<G1>(g1_bytes, cache);
+    CHECK(static_cast<serialized_field<G1>>(serialize(cached)) == g1_bytes);
+}
+
+TEST_CASE("Parallel parsing shares a parse cache between the threads", "[parse_cache][G1][parallel]")
+{
+    auto random = create_random_engine("parse cache parallel seed");
+    std::vector<serialized_field<G1>> bytes;
+    for(size_t i = 0; i < 8; ++i)
+    {
+        bytes.push_back(serialize(random-select_in<*G1>));
+    }
+    for(size_t i = 0; i < 56; ++i)
+    {
+        bytes.push_back(bytes[i % 8]);
+    }
+
+    ParseCache cache{ 16 };
+    const auto parsed = parse<G1>(parallel(4), bytes, cache);
+    REQUIRE(parsed.size() == bytes.size());
+    for(size_t i = 0; i < bytes.size(); ++i)
+    {
+        CAPTURE(i);
+        CHECK(parsed[i] == parse<G1>(bytes[i]));
+    }
+    CHECK(cache.size<G1>() == 8);
+}
+
+TEST_CASE("Parse caches keep only the most recently used points", "[parse_cache][G1]")
+{
+    auto random = create_random_engine("parse cache eviction seed");
+    std::vector<serialized_field<G1>> bytes;
+    for(size_t i = 0; i < 6; ++i)
+    {
+        bytes.push_back(serialize(random-select_in<*G1>));
+    }
+
+    ParseCache cache{ 4 };
+    const auto parsed = parse<G1>(bytes, cache);
+    REQUIRE(parsed.size() == bytes.size());
+    for(size_t index = 0; index < bytes.size(); ++index)
+    {
+        CAPTURE(index);
+        CHECK(parsed[index] == parse<G1>(bytes[index]));
+    }
+    CHECK(cache.size<G1>() == 4);
+
+    cache.clear();
+    CHECK(cache.size<G1>() == 0);
+    CHECK(cache.capacity() == 4);
+}
+
+TEST_CASE("Parse caches do not keep invalid encodings", "[parse_cache][G1]")
+{
+    serialized_field<G1> invalid_bytes{};
+    invalid_bytes.front() = static_cast<char>(0x80);
+
+    ParseCache cache{ 4 };
+    CHECK_THROWS_AS(parse<G1>(invalid_bytes, cache), std::runtime_error);
+    CHECK(cache.size<G1>() == 0);
+}
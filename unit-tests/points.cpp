@@ -0,0 +1,145 @@
+#include <optional>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+
+#include "points.hpp"
+
+using namespace crypto12381;
+using namespace crypto12381::tests;
+
+TEMPLATE_TEST_CASE("Products of long ranges of parsed points match repeated multiplication", "[G1][G2][arithmetic]",
+        detail::sets::G1_t, detail::sets::G2_t)
+{
+    constexpr auto G = TestType{};
+    auto random = create_random_engine("long product seed");
+    const auto g = select_parsed<G>(random);
+
+    // parsed points are affine and take the tree of affine additions, with equal, opposite and identity pairs
+    constexpr std::size_t n = 520;
+    std::vector<serialized_field<G>> bytes;
+    std::optional point{ g };
+    for(std::size_t k = 0; k < n; ++k)
+    {
+        if(k % 97 == 1)
+        {
+            bytes.push_back(bytes.back());
+        }
+        else if(k % 89 == 1)
+        {
+            bytes.push_back(serialize(inverse(*point)));
+        }
+        else if(k % 101 == 50)
+        {
+            bytes.push_back(serialize(g / g));
+        }
+        else
+        {
+            point.emplace(*point * g);
+            bytes.push_back(serialize(*point));
+        }
+    }
+    const auto h = parse<G>(bytes);
+
+    std::optional expected{ g / g };
+    for(const auto& e : h)
+    {
+        expected.emplace(*expected * e);
+    }
+    CHECK(product(h) == *expected);
+    CHECK(Π[n](h[i]) == *expected);
+}
+
+TEMPLATE_TEST_CASE("Powers of points by a shared number match separate powers", "[G1][G2][arithmetic]",
+        detail::sets::G1_t, detail::sets::G2_t)
+{
+    constexpr auto G = TestType{};
+    auto random = create_random_engine("shared power seed");
+    const auto first = select_parsed<G>(random);
+    const auto second = select_parsed<G>(random);
+    const auto identity = first / first;
+    const auto x = random-select_in<Zp>;
+    const auto r = random-select_in<Zp_bits<100>>;
+
+    const auto [U1, U2, U3] = pow_all(x, first, second, identity);
+    CHECK(U1 == (first ^ x));
+    CHECK(U2 == (second ^ x));
+    CHECK(U3 == identity);
+
+    const auto [V1, V2] = pow_all(r, first, second);
+    CHECK(V1 == (first ^ r.Zp_number()));
+    CHECK(V2 == (second ^ r.Zp_number()));
+
+    const std::vector points{ first, second, first * second };
+    for(const auto& number : { x, make_Zp(0), make_Zp(1), make_Zp(-1) })
+    {
+        const auto powers = pow_all(number, points);
+        const auto public_powers = pow_all(vartime(number), points);
+        REQUIRE(powers.size() == points.size());
+        for(std::size_t i = 0; i < points.size(); ++i)
+        {
+            CAPTURE(i);
+            CHECK(powers[i] == (points[i] ^ number));
+            CHECK(public_powers[i] == powers[i]);
+        }
+    }
+
+    const std::vector<typename decltype(points)::value_type> as_vector = pow_all(x, points);
+    CHECK(as_vector[2] == (points[2] ^ x));
+}
+
+TEMPLATE_TEST_CASE("Parsed points serialize to their source bytes until modified", "[G1][G2][serialization]",
+        detail::sets::G1_t, detail::sets::G2_t)
+{
+    constexpr auto G = TestType{};
+    auto random = create_random_engine("parsed bytes seed");
+    const auto point = select_parsed<G>(random);
+    const auto other = select_parsed<G>(random);
+    const serialized_field<G> bytes = serialize(point);
+    const serialized_field<G> other_bytes = serialize(other);
+
+    auto parsed = parse<G>(bytes);
+    CHECK(static_cast<serialized_field<G>>(serialize(parsed)) == bytes);
+    CHECK(static_cast<serialized_field<G>>(serialize(parsed * other / other)) == bytes);
+
+    const auto product = std::move(parsed) * other;
+    CHECK(static_cast<serialized_field<G>>(serialize(product)) != bytes);
+    CHECK(static_cast<serialized_field<G>>(serialize(product)) != other_bytes);
+    CHECK(static_cast<serialized_field<G>>(serialize(product / other)) == bytes);
+}
+
+TEMPLATE_TEST_CASE("Parsed points keep their source bytes as right operands", "[G1][G2][serialization]",
+        detail::sets::G1_t, detail::sets::G2_t)
+{
+    constexpr auto G = TestType{};
+    auto random = create_random_engine("parsed right operand seed");
+    const auto point = select_parsed<G>(random);
+    const auto other = select_parsed<G>(random);
+    const serialized_field<G> bytes = serialize(point);
+
+    auto parsed = parse<G>(bytes);
+    CHECK(other * parsed == other * point);
+    CHECK(other / parsed == other / point);
+    CHECK(static_cast<serialized_field<G>>(serialize(parsed)) == bytes);
+    CHECK(parsed == point);
+}
+
+TEMPLATE_TEST_CASE("Parsed points serialize canonically from non-canonical encodings", "[G1][G2][serialization]",
+        detail::sets::G1_t, detail::sets::G2_t)
+{
+    constexpr auto G = TestType{};
+    auto random = create_random_engine("non-canonical seed");
+    const auto point = select_parsed<G>(random);
+    const serialized_field<G> bytes = serialize(point);
+
+    // every 48 bytes coordinate of x after the prefix
+    auto non_canonical = bytes;
+    for(std::size_t offset = 1; offset < non_canonical.size(); offset += 48)
+    {
+        add_modulus(non_canonical.data() + offset);
+    }
+
+    const auto parsed = parse<G>(non_canonical);
+    CHECK(parsed == point);
+    CHECK(static_cast<serialized_field<G>>(serialize(parsed)) == bytes);
+}
@@ -0,0 +1,38 @@
+#ifndef CRYPTO12381_UNIT_TESTS_POINTS_HPP
+#define CRYPTO12381_UNIT_TESTS_POINTS_HPP
+
+#include <cstddef>
+
+#include <crypto12381/g1_point.hpp>
+#include <crypto12381/g2_point.hpp>
+
+namespace crypto12381::tests
+{
+    // a parsed point, which is affine unlike the lazy powers of select_in
+    template<auto Set>
+    auto select_parsed(RandomEngine& random)
+    {
+        const serialized_field<Set> bytes = serialize(random-select_in<*Set>);
+        return parse<Set>(bytes);
+    }
+
+    // add the base field modulus to the 48 bytes big-endian integer at bytes
+    inline void add_modulus(char* bytes)
+    {
+        constexpr unsigned char modulus[48] = {
+            0x1a, 0x01, 0x11, 0xea, 0x39, 0x7f, 0xe6, 0x9a, 0x4b, 0x1b, 0xa7, 0xb6,
+            0x43, 0x4b, 0xac, 0xd7, 0x64, 0x77, 0x4b, 0x84, 0xf3, 0x85, 0x12, 0xbf,
+            0x67, 0x30, 0xd2, 0xa0, 0xf6, 0xb0, 0xf6, 0x24, 0x1e, 0xab, 0xff, 0xfe,
+            0xb1, 0x53, 0xff, 0xff, 0xb9, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xaa, 0xab
+        };
+        unsigned carry = 0;
+        for(std::size_t i = 48; i-- > 0;)
+        {
+            carry += (unsigned char)bytes[i] + modulus[i];
+            bytes[i] = (char)carry;
+            carry >>= 8;
+        }
+    }
+}
+
+#endif
@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include <crypto12381/random.hpp>
@@ -5,6 +10,20 @@
 
 using namespace crypto12381;
 
+namespace
+{
+    std::array<char, 40> fill_from(std::span<const char> seed)
+    {
+        auto random = create_random_engine(seed, random_backend::aes_ctr);
+        std::array<char, 40> bytes;
+        random.fill(bytes);
+        return bytes;
+    }
+
+    // filled during the static initialization, which may come before the one of the library
+    const std::array<char, 40> static_bytes = fill_from("static aes seed");
+}
+
 TEST_CASE("Random engines with the same seed produce the same sequence", "[random]")
 {
     auto first = create_random_engine("repeatable seed");
@@ -38,3 +57,120 @@ TEST_CASE("Selecting from nonzero Zp never returns zero", "[random][Zp]")
         CHECK((random-select_in<*Zp>) != make_Zp(0));
     }
 }
+
+TEST_CASE("AES-CTR random engines are repeatable and differ from csprng engines", "[random]")
+{
+    auto first = create_random_engine("aes seed", random_backend::aes_ctr);
+    auto second = create_random_engine("aes seed", random_backend::aes_ctr);
+    auto csprng = create_random_engine("aes seed");
+
+    CHECK(first.backend() == random_backend::aes_ctr);
+    CHECK(csprng.backend() == random_backend::csprng);
+    for(int i = 0; i < 8; ++i)
+    {
+        const auto value = first-select_in<Zp>;
+        CHECK(value == second-select_in<Zp>);
+        CHECK(value != csprng-select_in<Zp>);
+    }
+}
+
+TEST_CASE("AES-CTR random engines work during the static initialization", "[random]")
+{
+    CHECK(static_bytes == fill_from("static aes seed"));
+    CHECK(static_bytes != std::array<char, 40>{});
+}
+
+TEST_CASE("Filling bytes covers the whole buffer", "[random]")
+{
+    auto random = create_random_engine("fill seed", random_backend::aes_ctr);
+    std::array<char, 100> first{};
+    std::array<char, 100> second{};
+    random.fill(first);
+    random.fill(second);
+
+    CHECK(first != second);
+    CHECK(std::ranges::count(first, 0) < 10);
+}
+
+TEST_CASE("Bulk selection in Zp matches selecting one by one", "[random][Zp]")
+{
+    auto bulk = create_random_engine("bulk seed");
+    auto single = create_random_engine("bulk seed");
+
+    const std::vector<detail::Zp_normalized_t> numbers = bulk-select_in<Zp>(5);
+    REQUIRE(numbers.size() == 5);
+    for(const auto& number : numbers)
+    {
+        CHECK(number == single-select_in<Zp>);
+    }
+
+    const auto [x, y, z] = bulk-select_in<Zp^3>;
+    CHECK(x == single-select_in<Zp>);
+    CHECK(y == single-select_in<Zp>);
+    CHECK(z == single-select_in<Zp>);
+}
+
+TEST_CASE("Bulk selection with AES-CTR returns distinct numbers", "[random][Zp]")
+{
+    auto random = create_random_engine("bulk aes seed", random_backend::aes_ctr);
+    const std::vector<detail::Zp_normalized_t> numbers = random-select_in<*Zp>(64);
+
+    REQUIRE(numbers.size() == 64);
+    for(size_t i = 0; i < numbers.size(); ++i)
+    {
+        CHECK(numbers[i] != make_Zp(0));
+        for(size_t j = 0; j < i; ++j)
+        {
+            CHECK(numbers[i] != numbers[j]);
+        }
+    }
+}
+
+TEST_CASE("Forked random engines are repeatable and independent", "[random]")
+{
+    auto first = create_random_engine("fork seed");
+    auto second = create_random_engine("fork seed");
+    auto first_children = first.fork(3);
+    auto second_children = second.fork(3);
+
+    REQUIRE(first_children.size() == 3);
+    const auto a = first_children[0]-select_in<Zp>;
+    const auto b = first_children[1]-select_in<Zp>;
+    const auto c = first_children[2]-select_in<Zp>;
+    CHECK(a == second_children[0]-select_in<Zp>);
+    CHECK(b == second_children[1]-select_in<Zp>);
+    CHECK(c == second_children[2]-select_in<Zp>);
+    CHECK(a != b);
+    CHECK(b != c);
+
+    // the parent moves on after forking
+    CHECK((first-select_in<Zp>) == (second-select_in<Zp>));
+    auto child = first.split();
+    CHECK((child-select_in<Zp>) != a);
+}
+
+TEST_CASE("Splitting matches forking a single engine", "[random]")
+{
+    for(const auto backend : { random_backend::csprng, random_backend::aes_ctr })
+    {
+        auto first = create_random_engine("split seed", backend);
+        auto second = create_random_engine("split seed", backend);
+        auto child = first.split();
+
+        CHECK(child.backend() == backend);
+        CHECK((child-select_in<Zp>) == (second.fork(1).front()-select_in<Zp>));
+    }
+}
+
+TEST_CASE("Parallel selection in Zp does not depend on the count of threads", "[random][Zp]")
+{
+    auto first = create_random_engine("parallel seed", random_backend::aes_ctr);
+    auto second = create_random_engine("parallel seed", random_backend::aes_ctr);
+
+    const std::vector<detail::Zp_normalized_t> one_thread = first-select_in<*Zp>(2500, parallel(1));
+    const std::vector<detail::Zp_normalized_t> four_threads = second-select_in<*Zp>(2500, parallel(4));
+
+    REQUIRE(one_thread.size() == 2500);
+    CHECK(one_thread == four_threads);
+    CHECK(one_thread[0] != one_thread[1024]);
+}
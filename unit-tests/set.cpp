@@ -1,5 +1,9 @@
 #include <array>
+#include <mutex>
+#include <set>
 #include <span>
+#include <stdexcept>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -71,6 +75,46 @@ TEST_CASE("Runtime-sized selection produces the requested number of elements", "
     }
 }
 
+TEST_CASE("Compile-time sized selection keeps the elements in an array", "[set][random]")
+{
+    auto random = create_random_engine("fixed selection seed");
+    auto same_random = create_random_engine("fixed selection seed");
+    const auto selected = random-select_in<Zp>(constant<5>);
+    const auto expected = same_random-select_in<Zp>(5) | materialize;
+
+    STATIC_REQUIRE(std::tuple_size_v<std::remove_cvref_t<decltype(unwrap(selected))>> == 5);
+    for(std::size_t index = 0; index < 5; ++index)
+    {
+        CAPTURE(index);
+        CHECK(selected[index] == expected[index]);
+    }
+
+    const auto nonzero = random-select_in<*Zp>(constant<4>);
+    STATIC_REQUIRE(std::tuple_size_v<std::remove_cvref_t<decltype(unwrap(nonzero))>> == 4);
+    for(const auto& value : nonzero)
+    {
+        CHECK(value != make_Zp(0));
+    }
+
+    const auto points = random-select_in<*G1>(constant<3>);
+    STATIC_REQUIRE(std::tuple_size_v<std::remove_cvref_t<decltype(unwrap(points))>> == 3);
+    CHECK(points[0] != points[1]);
+    CHECK(points[1] != points[2]);
+}
+
+TEST_CASE("Compile-time sized materialization checks the size of the range", "[set][algebra]")
+{
+    auto squares = sequence(0, 4) | transform([](int k){ return k * k; }) | materialize(constant<4>);
+    STATIC_REQUIRE(std::same_as<std::remove_cvref_t<decltype(unwrap(squares))>, std::array<int, 4>>);
+    CHECK(squares[0] == 0);
+    CHECK(squares[3] == 9);
+
+    auto odds = sequence(0, 6) | filter([](int k){ return k % 2 == 1; }) | materialize(constant<3>);
+    CHECK(odds[2] == 5);
+
+    CHECK_THROWS_AS(sequence(0, 5) | materialize(constant<4>), std::runtime_error);
+}
+
 TEST_CASE("Combined serialization and parsing preserve heterogeneous elements", "[set][serialization]")
 {
     auto random = create_random_engine("heterogeneous serialization seed");
@@ -86,6 +130,23 @@ TEST_CASE("Combined serialization and parsing preserve heterogeneous elements",
     CHECK(parsed_second == second);
 }
 
+TEST_CASE("Schemas switch between compressed and uncompressed points by type", "[set][serialization]")
+{
+    auto random = create_random_engine("uncompressed schema seed");
+    const auto scalar = random-select_in<Zp>;
+    const auto first = select_g1(random);
+    const auto second = select_g2(random);
+
+    const serialized_field<Zp, G1u, G2u> uncompressed = serialize_as<Zp, G1u, G2u>(scalar, first, second);
+    const auto [parsed_scalar, parsed_first, parsed_second] = parse<Zp | G1u | G2u>(uncompressed);
+    CHECK(parsed_scalar == scalar);
+    CHECK(parsed_first == first);
+    CHECK(parsed_second == second);
+
+    const serialized_field<Zp, G1, G2> compressed = serialize_as<Zp, G1, G2>(scalar, first, second);
+    CHECK(compressed == serialized_field<Zp, G1, G2>(serialize(scalar, first, second)));
+}
+
 TEST_CASE("Cartesian set expressions parse serialized products", "[set][serialization]")
 {
     auto random = create_random_engine("Cartesian set parsing seed");
@@ -117,7 +178,7 @@ TEST_CASE("Serialization writes into caller-defined records", "[set][serializati
     CHECK(parsed_point == point);
 }
 
-TEST_CASE("Ranges of serialized fields parse lazily", "[set][serialization]")
+TEST_CASE("Ranges of serialized fields parse into a materialized range", "[set][serialization]")
 {
     const std::array values{ make_Zp(3), make_Zp(5), make_Zp(8) };
     const std::array<serialized_field<Zp>, 3> bytes{
@@ -135,6 +196,120 @@ TEST_CASE("Ranges of serialized fields parse lazily", "[set][serialization]")
     }
 }
 
+TEST_CASE("Ranges of serialized fields of a size known at compile time parse in place", "[set][serialization]")
+{
+    const std::array values{ make_Zp(3), make_Zp(5), make_Zp(8) };
+    const std::array<serialized_field<Zp>, 3> bytes{
+        serialize(values[0]),
+        serialize(values[1]),
+        serialize(values[2])
+    };
+
+    auto in_place = parse<Zp>(bytes);
+    auto spanned = parse<Zp>(std::span<const serialized_field<Zp>, 3>{ bytes });
+    STATIC_REQUIRE(std::tuple_size_v<std::remove_cvref_t<decltype(unwrap(in_place))>> == 3);
+    STATIC_REQUIRE(std::tuple_size_v<std::remove_cvref_t<decltype(unwrap(spanned))>> == 3);
+    CHECK(in_place[2] == values[2]);
+    CHECK(spanned[1] == values[1]);
+}
+
+TEST_CASE("Ranges of serialized points parse each element once in order", "[set][serialization][G1]")
+{
+    auto random = create_random_engine("range parse seed");
+    const auto g = select_g1(random);
+    const auto x = random-select_in<Zp>(100);
+
+    std::vector<serialized_field<G1>> bytes;
+    for(const auto& e : x)
+    {
+        bytes.push_back(serialize(g ^ e));
+    }
+
+    auto parsed = parse<G1>(bytes);
+    REQUIRE(parsed.size() == bytes.size());
+    for(std::size_t index = 0; index < bytes.size(); ++index)
+    {
+        CAPTURE(index);
+        CHECK(parsed[index] == (g ^ x[index]));
+    }
+
+    auto parsed_in_parallel = parse<G1>(parallel(4), bytes);
+    REQUIRE(parsed_in_parallel.size() == bytes.size());
+    for(std::size_t index = 0; index < bytes.size(); ++index)
+    {
+        CAPTURE(index);
+        CHECK(parsed_in_parallel[index] == parsed[index]);
+    }
+    CHECK(parse_checked<G1>(parallel(4), bytes)[99] == parsed[99]);
+
+    bytes[70].front() = static_cast<char>(0x80);
+    CHECK_THROWS_AS(parse<G1>(bytes), std::runtime_error);
+    CHECK_THROWS_AS(parse<G1>(parallel(4), bytes), std::runtime_error);
+}
+
+TEST_CASE("Checked parsing accepts points of the prime order subgroup", "[set][serialization]")
+{
+    auto random = create_random_engine("checked parse seed");
+    const auto scalar = random-select_in<Zp>;
+    const auto first = select_g1(random);
+    const auto second = select_g2(random);
+    const auto identity = first / first;
+
+    const serialized_field<Zp, G1, G2> record = serialize(scalar, first, second);
+    const auto [parsed_scalar, parsed_first, parsed_second] = parse_checked<Zp, G1, G2>(record);
+    CHECK(parsed_scalar == scalar);
+    CHECK(parsed_first == first);
+    CHECK(parsed_second == second);
+
+    const serialized_field<G1> identity_bytes = serialize(identity);
+    CHECK(parse_checked<G1>(identity_bytes) == identity);
+}
+
+TEST_CASE("Checked parsing rejects points outside of the prime order subgroup", "[set][serialization]")
+{
+    // most small x give points on the curve whose order is not r
+    size_t n_g1_rejected = 0;
+    size_t n_g2_rejected = 0;
+    for(char x = 0; x < 16; ++x)
+    {
+        serialized_field<G1> g1_bytes{};
+        g1_bytes.front() = 0x02;
+        g1_bytes.back() = x;
+        serialized_field<G2> g2_bytes{};
+        g2_bytes.front() = 0x02;
+        g2_bytes.back() = x;
+
+        try
+        {
+            const auto point = parse<G1>(g1_bytes);
+            if(!point.is_in_subgroup())
+            {
+                CHECK_THROWS_AS(parse_checked<G1>(g1_bytes), std::runtime_error);
+                CHECK_THROWS_AS(parse_checked<G1 ^ 2>(serialize(point, point).to()), std::runtime_error);
+                ++n_g1_rejected;
+            }
+        }
+        catch(const std::runtime_error&)
+        {
+        }
+
+        try
+        {
+            const auto point = parse<G2>(g2_bytes);
+            if(!point.is_in_subgroup())
+            {
+                CHECK_THROWS_AS(parse_checked<G2>(g2_bytes), std::runtime_error);
+                ++n_g2_rejected;
+            }
+        }
+        catch(const std::runtime_error&)
+        {
+        }
+    }
+    CHECK(n_g1_rejected > 0);
+    CHECK(n_g2_rejected > 0);
+}
+
 TEST_CASE("Hashing equivalent element sequences produces the same Zp value", "[set][hash]")
 {
     auto random = create_random_engine("hash equivalence seed");
@@ -151,6 +326,39 @@ TEST_CASE("Hashing equivalent element sequences produces the same Zp value", "[s
     CHECK(variadic == piped);
 }
 
+TEST_CASE("Forked hash states continue from the absorbed prefix", "[set][hash]")
+{
+    auto random = create_random_engine("hash fork seed");
+    const auto [first, second, third] = random-select_in<Zp ^ 3>;
+
+    auto prefix = hash(first, second);
+    const auto forked = (prefix.fork() | third).to(Zp);
+    const auto original = (std::move(prefix) | third).to(Zp);
+
+    CHECK(forked == original);
+    CHECK(forked == hash(first, second, third).to(Zp));
+}
+
+TEST_CASE("Symbolic hash suffixes match hashing every element separately", "[set][hash]")
+{
+    auto random = create_random_engine("hash suffix seed");
+    const auto [first, second] = random-select_in<Zp ^ 2>;
+
+    auto shared = hash(first, second, i).to(Zp) (i.in[3]) | materialize;
+    auto piped = (hash(first, second) | i).to(Zp) (i.in[3]) | materialize;
+
+    REQUIRE(shared.size() == 3);
+    REQUIRE(piped.size() == 3);
+    for(int index = 0; index < 3; ++index)
+    {
+        CAPTURE(index);
+        const auto expected = hash(first, second, index).to(Zp);
+
+        CHECK(shared[index] == expected);
+        CHECK(piped[index] == expected);
+    }
+}
+
 TEST_CASE("Hashing a Zp range is independent of its container type", "[set][hash]")
 {
     auto random = create_random_engine("hash container seed");
@@ -215,6 +423,81 @@ TEST_CASE("Generic sum and product symbolically aggregate Zp ranges", "[set][Zp]
     CHECK(Π[values.size()](algebraic_values[i]) == make_Zp(24));
 }
 
+TEST_CASE("Sums and products with invariant lazy values match the eager ones", "[set][Zp][G1]")
+{
+    auto random = create_random_engine("invariant lazy value seed");
+    const std::array values{ make_Zp(1), make_Zp(2), make_Zp(3), make_Zp(4) };
+    const auto v = values | algebraic;
+    const std::array points{ select_g1(random), select_g1(random), select_g1(random) };
+    const auto h = points | algebraic;
+    const auto point = select_g1(random);
+    const auto [a, b] = random-select_in<Zp ^ 2>;
+    const auto ab = a * b;
+    const auto power = point ^ a;
+
+    CHECK(Σ[values.size()](v[i] * ab) == make_Zp(10) * (a * b));
+    CHECK(Π[points.size()](h[i] * power) == Π[points.size()](h[i]) * (point ^ (a + a + a)));
+    CHECK(Π[parallel, points.size()](h[i] ^ ab) == (Π[points.size()](h[i]) ^ (a * b)));
+}
+
+TEST_CASE("Parallel sums and products match the sequential ones", "[set][Zp][parallel]")
+{
+    constexpr std::size_t n = 200;
+    std::vector<decltype(make_Zp(0))> values;
+    for(std::size_t k = 1; k <= n; ++k)
+    {
+        values.push_back(make_Zp(k));
+    }
+    const auto v = values | algebraic;
+
+    CHECK(sum(parallel, values) == make_Zp(n * (n + 1) / 2));
+    CHECK(Σ[parallel, n](v[i] * v[i]) == Σ[n](v[i] * v[i]));
+    CHECK(Π[parallel, n](v[i]) == Π[n](v[i]));
+    CHECK(Π[parallel(3), n](v[i]) == Π[parallel(1), n](v[i]));
+    CHECK(Σ[parallel, 0uz](v[i]) == make_Zp(0));
+}
+
+TEST_CASE("Nested parallel sums run on the threads of the outer one", "[set][Zp][parallel]")
+{
+    constexpr std::size_t n = 40;
+    std::vector<decltype(make_Zp(0))> values;
+    for(std::size_t k = 1; k <= n; ++k)
+    {
+        values.push_back(make_Zp(k));
+    }
+    const auto v = values | algebraic;
+
+    // the threads of the pool are kept between the calls, and a nested call does not take more of them
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    for(int round = 0; round < 2; ++round)
+    {
+        CHECK(Σ[parallel(4), n](Σ[parallel(4), n](v[i]) * v[i]) == Σ[n](v[i]) * Σ[n](v[i]));
+        detail::parallel_for(n, [&](std::size_t)
+        {
+            detail::parallel_for(n, [&](std::size_t)
+            {
+                std::lock_guard lock{ mutex };
+                threads.insert(std::this_thread::get_id());
+            }, parallel(4));
+        }, parallel(4));
+    }
+    CHECK(threads.size() <= 4);
+}
+
+TEST_CASE("A range piped to parallel is evaluated once for each element", "[set][hash][parallel]")
+{
+    constexpr std::size_t n = 100;
+    const auto x = make_Zp(7);
+
+    const auto q = (hash(x) | i).to(Zp)(i.in[n]) | parallel;
+    REQUIRE(q.size() == n);
+    for(std::size_t k = 0; k < n; ++k)
+    {
+        CHECK(q[k] == (hash(x) | k).to(Zp));
+    }
+}
+
 TEST_CASE("Generic sum returns zero for an empty Zp range", "[set][Zp]")
 {
     const std::array<decltype(make_Zp(0)), 0> empty{};
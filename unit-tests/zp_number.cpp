@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <limits>
@@ -169,6 +170,27 @@ TEST_CASE("Zp parsing rejects values above the scalar field modulus", "[Zp][seri
     CHECK_THROWS_AS(parse<Zp>(bytes), std::runtime_error);
 }
 
+TEST_CASE("Bounded Zp numbers stay below their bound", "[Zp]")
+{
+    auto random = create_random_engine("bounded Zp seed");
+    const auto bound = make_Zp(std::uint64_t{ 1 } << 20);
+
+    for(int iteration = 0; iteration < 16; ++iteration)
+    {
+        CAPTURE(iteration);
+        const auto x = random-select_in<Zp_bits<20>>;
+        const serialized_field<Zp> bytes = serialize(x);
+
+        CHECK(std::all_of(bytes.begin(), bytes.end() - 3, [](char byte){ return byte == 0; }));
+        CHECK((unsigned char)bytes[bytes.size() - 3] < 0x10);
+        CHECK(parse<Zp_bits<20>>(bytes).Zp_number() == x.Zp_number());
+    }
+
+    CHECK_NOTHROW(bounded<20>(bound - make_Zp(1)));
+    CHECK_THROWS_AS(bounded<20>(bound), std::runtime_error);
+    CHECK_THROWS_AS(parse<Zp_bits<20>>(serialize(bound).to<serialized_field<Zp>>()), std::runtime_error);
+}
+
 TEST_CASE("Zp message encoding accepts an empty message", "[Zp][encoding]")
 {
     const auto encoded = encode_to<Zp>(std::span<const char>{});